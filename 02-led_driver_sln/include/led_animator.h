@@ -0,0 +1,97 @@
+#pragma once
+#include "led.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// One step of an animation: hold a color for duration_ms
+struct Keyframe {
+    const char* name;
+    bool red;
+    bool green;
+    bool blue;
+    uint32_t duration_ms;
+};
+
+// A sequence of keyframes, usually a constexpr table
+struct Timeline {
+    const Keyframe* frames;
+    size_t count;
+    uint32_t repeat;    // number of plays, 0 = loop forever
+};
+
+template <size_t N>
+constexpr Timeline make_timeline(const std::array<Keyframe, N>& frames, uint32_t repeat = 0) {
+    return Timeline{frames.data(), N, repeat};
+}
+
+
+// === LED animator ===
+// Plays keyframe timelines on any number of LEDs from a single one-shot esp_timer.
+// The timer is re-armed for the earliest upcoming keyframe, so nothing runs between
+// color changes and no task is tied up sleeping.
+class LedAnimator {
+public:
+    static constexpr size_t MAX_TRACKS = 8;
+    static constexpr int NO_TRACK = -1;
+
+    // Timing measurements, all in microseconds
+    struct Stats {
+        uint32_t callbacks;     // timer callbacks run
+        uint32_t max_late_us;   // worst delay between a keyframe's due time and the callback
+        uint64_t total_late_us; // sum of delays, divide by callbacks for the mean
+        uint64_t busy_us;       // time spent inside callbacks
+        uint64_t elapsed_us;    // time since the animator was created
+    };
+
+    LedAnimator();
+    ~LedAnimator();
+
+    LedAnimator(const LedAnimator&) = delete;
+    LedAnimator& operator=(const LedAnimator&) = delete;
+
+    // Start a timeline; returns a track id, or NO_TRACK if all tracks are busy or
+    // the timeline is empty or takes no time.
+    // An RGB LED shows the keyframe colors, any other LED is lit for non-black frames.
+    int play(MultiColorLed& led, const Timeline& timeline);
+    int play(Led& led, const Timeline& timeline);
+
+    // Stop a track and leave its LED in the current state
+    void stop(int track);
+
+    // True while the track still has keyframes to play
+    bool is_playing(int track) const;
+
+    // Name of the keyframe a track is showing, or nullptr if stopped
+    const char* current_frame(int track) const;
+
+    Stats stats() const;
+
+private:
+    struct Track {
+        Led* led = nullptr;             // Target for on/off
+        MultiColorLed* rgb = nullptr;   // Target for colors, if it is an RGB LED
+        Timeline timeline = {};
+        size_t frame = 0;               // Index of the frame being shown
+        uint32_t plays = 0;             // Completed plays of the timeline
+        int64_t next_us = 0;            // When the next frame is due
+        bool active = false;
+    };
+
+    std::array<Track, MAX_TRACKS> tracks_;
+    esp_timer_handle_t timer_;
+    SemaphoreHandle_t mutex_;           // Guards tracks_ and stats_
+    int64_t start_us_;
+    Stats stats_;
+
+    int start_track(Led* led, MultiColorLed* rgb, const Timeline& timeline);
+    void show(Track& track);
+    void advance(Track& track);
+    void schedule(int64_t now_us);      // re-arm the timer for the earliest track
+
+    static void timer_callback(void* arg);
+    void on_timer();
+};
@@ -0,0 +1,191 @@
+#include "led_animator.h"
+#include <algorithm>
+#include <limits>
+
+LedAnimator::LedAnimator()
+    : timer_(nullptr),
+      mutex_(xSemaphoreCreateMutex()),
+      start_us_(esp_timer_get_time()),
+      stats_{}
+{
+    esp_timer_create_args_t args = {};
+    args.callback = &LedAnimator::timer_callback;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "led_animator";
+    esp_timer_create(&args, &timer_);
+}
+
+LedAnimator::~LedAnimator() {
+    esp_timer_stop(timer_);
+    esp_timer_delete(timer_);
+    vSemaphoreDelete(mutex_);
+}
+
+int LedAnimator::play(MultiColorLed& led, const Timeline& timeline) {
+    return start_track(&led, &led, timeline);
+}
+
+int LedAnimator::play(Led& led, const Timeline& timeline) {
+    return start_track(&led, nullptr, timeline);
+}
+
+int LedAnimator::start_track(Led* led, MultiColorLed* rgb, const Timeline& timeline) {
+    if (timeline.frames == nullptr || timeline.count == 0) {
+        return NO_TRACK;
+    }
+
+    // A timeline that takes no time would re-arm the timer in a tight loop
+    uint64_t total_ms = 0;
+    for (size_t i = 0; i < timeline.count; ++i) {
+        total_ms += timeline.frames[i].duration_ms;
+    }
+    if (total_ms == 0) {
+        return NO_TRACK;
+    }
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+
+    auto free_track = std::find_if(tracks_.begin(), tracks_.end(),
+                                   [](const Track& t) { return !t.active; });
+    if (free_track == tracks_.end()) {
+        xSemaphoreGive(mutex_);
+        return NO_TRACK;
+    }
+
+    int64_t now = esp_timer_get_time();
+    Track& track = *free_track;
+    track.led = led;
+    track.rgb = rgb;
+    track.timeline = timeline;
+    track.frame = 0;
+    track.plays = 0;
+    track.next_us = now + timeline.frames[0].duration_ms * 1000LL;
+    track.active = true;
+    show(track);
+
+    schedule(now);
+    xSemaphoreGive(mutex_);
+
+    return static_cast<int>(free_track - tracks_.begin());
+}
+
+void LedAnimator::stop(int track) {
+    if (track < 0 || track >= static_cast<int>(MAX_TRACKS)) {
+        return;
+    }
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    tracks_[track].active = false;
+    schedule(esp_timer_get_time());
+    xSemaphoreGive(mutex_);
+}
+
+bool LedAnimator::is_playing(int track) const {
+    if (track < 0 || track >= static_cast<int>(MAX_TRACKS)) {
+        return false;
+    }
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    bool active = tracks_[track].active;
+    xSemaphoreGive(mutex_);
+    return active;
+}
+
+const char* LedAnimator::current_frame(int track) const {
+    if (track < 0 || track >= static_cast<int>(MAX_TRACKS)) {
+        return nullptr;
+    }
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    const Track& t = tracks_[track];
+    const char* name = t.active ? t.timeline.frames[t.frame].name : nullptr;
+    xSemaphoreGive(mutex_);
+    return name;
+}
+
+LedAnimator::Stats LedAnimator::stats() const {
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    Stats copy = stats_;
+    xSemaphoreGive(mutex_);
+
+    copy.elapsed_us = esp_timer_get_time() - start_us_;
+    return copy;
+}
+
+void LedAnimator::show(Track& track) {
+    const Keyframe& frame = track.timeline.frames[track.frame];
+
+    if (track.rgb != nullptr) {
+        track.rgb->set_color(frame.red, frame.green, frame.blue);
+    } else if (frame.red || frame.green || frame.blue) {
+        track.led->on();
+    } else {
+        track.led->off();
+    }
+}
+
+void LedAnimator::advance(Track& track) {
+    if (++track.frame == track.timeline.count) {
+        track.frame = 0;
+        ++track.plays;
+
+        // Finished: leave the last frame showing
+        if (track.timeline.repeat != 0 && track.plays >= track.timeline.repeat) {
+            track.active = false;
+            return;
+        }
+    }
+
+    show(track);
+
+    // Step from the due time, not from now, so lateness does not accumulate
+    track.next_us += track.timeline.frames[track.frame].duration_ms * 1000LL;
+}
+
+void LedAnimator::schedule(int64_t now_us) {
+    int64_t earliest = std::numeric_limits<int64_t>::max();
+    for (const Track& track : tracks_) {
+        if (track.active) {
+            earliest = std::min(earliest, track.next_us);
+        }
+    }
+
+    esp_timer_stop(timer_);
+    if (earliest != std::numeric_limits<int64_t>::max()) {
+        esp_timer_start_once(timer_, static_cast<uint64_t>(std::max<int64_t>(earliest - now_us, 0)));
+    }
+}
+
+void LedAnimator::timer_callback(void* arg) {
+    static_cast<LedAnimator*>(arg)->on_timer();
+}
+
+void LedAnimator::on_timer() {
+    int64_t entered = esp_timer_get_time();
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+
+    // Jitter is measured against the earliest keyframe that was due
+    int64_t due = std::numeric_limits<int64_t>::max();
+    for (Track& track : tracks_) {
+        if (track.active && track.next_us <= entered) {
+            due = std::min(due, track.next_us);
+            advance(track);
+        }
+    }
+
+    if (due != std::numeric_limits<int64_t>::max()) {
+        uint32_t late = static_cast<uint32_t>(entered - due);
+        stats_.max_late_us = std::max(stats_.max_late_us, late);
+        stats_.total_late_us += late;
+    }
+
+    int64_t now = esp_timer_get_time();
+    schedule(now);
+
+    stats_.callbacks++;
+    stats_.busy_us += static_cast<uint64_t>(esp_timer_get_time() - entered);
+
+    xSemaphoreGive(mutex_);
+}
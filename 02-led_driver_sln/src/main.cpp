@@ -1,26 +1,20 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "led.h"
-#include <iostream>
+#include "led_animator.h"
 #include <array>
-
-// structure to hold color test data
-struct ColorTest {
-    const char* name;
-    bool red;
-    bool green;
-    bool blue;
-};
+#include <cstdio>
 
 // define color test sequence
-constexpr std::array<ColorTest, 7> color_sequence = {{
-    {"Red",                    true,  false, false},
-    {"Green",                  false, true,  false},
-    {"Blue",                   false, false, true},
-    {"Yellow (Red + Green)",   true,  true,  false},
-    {"Purple (Red + Blue)",    true,  false, true},
-    {"Cyan (Green + Blue)",    false, true,  true},
-    {"All LEDs OFF",           false, false, false}
+// the last frame holds "off" for an extra second before the sequence starts over
+constexpr std::array<Keyframe, 7> color_sequence = {{
+    {"Red",                    true,  false, false, 2000},
+    {"Green",                  false, true,  false, 2000},
+    {"Blue",                   false, false, true,  2000},
+    {"Yellow (Red + Green)",   true,  true,  false, 2000},
+    {"Purple (Red + Blue)",    true,  false, true,  2000},
+    {"Cyan (Green + Blue)",    false, true,  true,  2000},
+    {"All LEDs OFF",           false, false, false, 3000}
 }};
 
 // sleep function using FreeRTOS
@@ -30,19 +24,24 @@ inline void sleep_ms(int ms) {
 
 extern "C" void app_main() {
 
-    MultiColorLed rgb_led(GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25, Led::Configuration::CommonAnode);
+    static MultiColorLed rgb_led(GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25, Led::Configuration::CommonAnode);
+    static LedAnimator animator;
+
+    printf("LED Demo Starting...\n");
+
+    // The animator plays the sequence from a timer; this task only reports on it
+    int track = animator.play(rgb_led, make_timeline(color_sequence));
 
-    std::cout << "LED Demo Starting..." << std::endl;
-    
     while (true) {
+        sleep_ms(10000);
 
-        for (const auto& test : color_sequence) {
-            std::cout << "RGB LED - " << test.name << std::endl;
-            rgb_led.set_color(test.red, test.green, test.blue);
-            sleep_ms(2000);
-        }
-        
-        std::cout << "=== Sequence Complete - Starting Over ===" << std::endl;
-        sleep_ms(1000);
+        LedAnimator::Stats stats = animator.stats();
+        const char* frame = animator.current_frame(track);
+        uint32_t mean_late_us = stats.callbacks ? stats.total_late_us / stats.callbacks : 0;
+        float cpu_percent = stats.elapsed_us ? 100.0f * stats.busy_us / stats.elapsed_us : 0.0f;
+
+        printf("RGB LED - %s | callbacks: %u | jitter mean/max: %u/%u us | cpu: %.3f %%\n",
+               frame != nullptr ? frame : "(stopped)", static_cast<unsigned>(stats.callbacks),
+               static_cast<unsigned>(mean_late_us), static_cast<unsigned>(stats.max_late_us), cpu_percent);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,465 @@
+// Host benchmark runner: the bench::run_all() suite against simulated peripherals,
+// plus measurements that need a scripted world around the firmware.
+//
+// Usage: proximity_bench > bench.csv
+//
+// Prints two CSV tables. The first is the per-call suite from src/bench.cpp with
+// an allocation count per call (host "cycles" are nanoseconds). Calls that reach
+// the fake HAL also count the simulator's own allocations, e.g. for its event
+// queue in measure_distance_avg. The second holds
+// scenario metrics on the virtual clock: UltrasonicArray sweep rate, how long a
+// measurement blocks with and without a range-limited timeout, whether one
+// spurious echo changes the zone, and the adaptive sampling rate and warning
+// latency against a fixed 200 ms period.
+#include "bench.h"
+#include "echo_model.h"
+#include "proximity_controller.h"
+#include "pwm_led.h"
+#include "static_led.h"
+#include "ultrasonic_array.h"
+#include "window_stats.h"
+#include "sim/gpio.h"
+#include "sim/kernel.h"
+#include "sim/ledc.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <vector>
+
+// === Allocation counting ===
+static std::atomic<uint64_t> allocation_count{0};
+
+void* operator new(std::size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+uint64_t count_allocations() {
+    return allocation_count.load(std::memory_order_relaxed);
+}
+
+// Pins as wired in app_main()
+constexpr gpio_num_t TRIGGER_PIN = GPIO_NUM_16;
+constexpr gpio_num_t ECHO_PIN = GPIO_NUM_17;
+constexpr gpio_num_t RED_PIN = GPIO_NUM_27;
+constexpr gpio_num_t BLUE_PIN = GPIO_NUM_25;
+
+constexpr float WARN_THRESHOLD_CM = 20.0f;
+
+// === Scenes (time relative to the start of the scene) ===
+float bench_scene(int64_t) {
+    return 50.0f;
+}
+
+// Nothing closer than 2.5 m
+float clear_scene(int64_t) {
+    return 250.0f;
+}
+
+// Nothing in range at all: the module holds its echo for ~38 ms
+float empty_scene(int64_t) {
+    return 0.0f;
+}
+
+float far_scene(int64_t) {
+    return 150.0f;
+}
+
+// Clear for 5 s, then an object closes from 250 cm at 1 m/s and stops at 5 cm
+constexpr float APPROACH_START_S = 5.0f;
+constexpr float APPROACH_SPEED_CM_S = 100.0f;
+
+float approach_scene(int64_t time_us) {
+    float t = time_us / 1e6f - APPROACH_START_S;
+    if (t < 0.0f) return 250.0f;
+    float distance = 250.0f - APPROACH_SPEED_CM_S * t;
+    return distance > 5.0f ? distance : 5.0f;
+}
+
+float (*current_scene)(int64_t) = bench_scene;
+int64_t scene_start_us = 0;
+
+// First time the LED showed Warning or Danger (red lit, blue dark) since the scene started
+bool warning_seen = false;
+int64_t first_warning_us = 0;
+
+void watch_for_warning() {
+    static bool sample_pending = false;
+    auto on_led_pin = [](int) {
+        if (sample_pending) {
+            return;
+        }
+        // Sample once the set/clear register pair has landed
+        sample_pending = true;
+        sim::schedule_in(1, [] {
+            sample_pending = false;
+            bool red = sim::output_level(RED_PIN) == 0;     // common anode
+            bool blue = sim::output_level(BLUE_PIN) == 0;
+            if (red && !blue && !warning_seen) {
+                warning_seen = true;
+                first_warning_us = sim::now_us();
+            }
+        });
+    };
+    sim::watch_pin(RED_PIN, on_led_pin);
+    sim::watch_pin(BLUE_PIN, on_led_pin);
+}
+
+// Run fn as a simulated task and let the simulation run until it returns
+void run_task(const char* name, std::function<void()> fn) {
+    std::atomic<bool> done{false};
+    sim::start_task(name, [&] {
+        fn();
+        done = true;
+    });
+    while (!done) {
+        sim::run_until(sim::now_us() + 100000);
+    }
+}
+
+void print_metric(const char* name, double value, const char* unit) {
+    printf("%s,%.2f,%s\n", name, value, unit);
+}
+
+// === Per-call suite ===
+void run_suite() {
+    bench::set_allocation_counter(count_allocations);
+    bench::run_all();
+
+    // iostream formatting of the controller's diagnostics line, for comparison
+    // with log.deferred and log.snprintf (host only, it bloats the firmware)
+    std::ostringstream out;
+    float distance = 42.0f;
+    bench::print(bench::measure("log.ostream", bench::LOG_BATCH, [&] {
+        out.str("");
+        out << "Distance:" << distance << " cm | median " << distance << " | mean " << distance
+            << " +/- " << 0.5f << " | closing " << 1.0f << " cm/s | next " << 60 << " ms | " << "Safe";
+        bench::keep(out);
+    }, bench::LOG_REPEATS));
+}
+
+// === WindowStats against brute force ===
+// Sliding min/max/mean checked sample by sample against a direct scan. A rising
+// ramp fills the min queue and a falling one the max queue, so at window == N
+// they run at full capacity; the random input covers the general case.
+enum class Pattern { Random, Rising, Falling };
+
+template <size_t N>
+uint32_t window_mismatches(size_t window, Pattern pattern) {
+    util::WindowStats<N> stats(window);
+    std::vector<float> history;
+    uint32_t state = 12345;
+    uint32_t mismatches = 0;
+    for (int i = 0; i < 1000; ++i) {
+        state = state * 1664525u + 1013904223u;
+        float value = 5.0f + (state >> 8) % 4000 / 10.0f;
+        if (pattern == Pattern::Rising) {
+            value = 5.0f + i * 0.25f;
+        } else if (pattern == Pattern::Falling) {
+            value = 400.0f - i * 0.25f;
+        }
+        stats.push(value);
+        history.push_back(value);
+
+        size_t n = std::min(history.size(), window);
+        auto begin = history.end() - static_cast<std::ptrdiff_t>(n);
+        float lo = *std::min_element(begin, history.end());
+        float hi = *std::max_element(begin, history.end());
+        float sum = 0.0f;
+        for (auto it = begin; it != history.end(); ++it) {
+            sum += *it;
+        }
+        if (stats.min() != lo || stats.max() != hi || std::fabs(stats.mean() - sum / n) > 0.01f) {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+void run_window_check() {
+    print_metric("window_stats.random.w64_of_64.mismatches", window_mismatches<64>(64, Pattern::Random), "samples");
+    print_metric("window_stats.random.w8_of_64.mismatches", window_mismatches<64>(8, Pattern::Random), "samples");
+    print_metric("window_stats.rising.w64_of_64.mismatches", window_mismatches<64>(64, Pattern::Rising), "samples");
+    print_metric("window_stats.falling.w64_of_64.mismatches", window_mismatches<64>(64, Pattern::Falling), "samples");
+    print_metric("window_stats.rising.w1_of_1.mismatches", window_mismatches<1>(1, Pattern::Rising), "samples");
+}
+
+// === PwmRgbLed duty output ===
+// Every 8-bit level must reach the LEDC channels as its gamma table entry, the
+// table must rise from dark to full duty, and a fade must land on its target
+// (and not go past it midway); off() during a fade cancels it
+template <typename PwmLed>
+uint32_t pwm_mismatches(ledc_timer_t timer, ledc_channel_t first_channel) {
+    PwmLed led(GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25, driver::Led::Configuration::CommonCathode,
+               timer, first_channel);
+    const auto& gamma = PwmLed::GAMMA_TABLE;
+    auto duty = [&](int channel) {
+        return sim::ledc_duty(LEDC_LOW_SPEED_MODE, static_cast<ledc_channel_t>(first_channel + channel));
+    };
+
+    uint32_t mismatches = 0;
+    for (int level = 0; level < 256; ++level) {
+        led.set_rgb(level, 255 - level, level / 2);
+        mismatches += duty(0) != gamma[level] || duty(1) != gamma[255 - level] || duty(2) != gamma[level / 2];
+    }
+    mismatches += gamma[0] != 0 || gamma[255] != (1u << PwmLed::DUTY_BITS) - 1;
+    for (size_t i = 1; i < gamma.size(); ++i) {
+        mismatches += gamma[i] < gamma[i - 1];
+    }
+
+    led.set_rgb(0, 0, 0);
+    led.fade_to_rgb(255, 128, 0, 500);
+    vTaskDelay(pdMS_TO_TICKS(250));
+    mismatches += duty(0) > gamma[255] || duty(1) > gamma[128] || duty(2) != 0;
+    vTaskDelay(pdMS_TO_TICKS(300));
+    mismatches += duty(0) != gamma[255] || duty(1) != gamma[128] || duty(2) != 0;
+
+    led.fade_to_rgb(255, 255, 255, 500);
+    led.off();
+    vTaskDelay(pdMS_TO_TICKS(600));
+    mismatches += duty(0) != 0 || duty(1) != 0 || duty(2) != 0;
+    return mismatches;
+}
+
+void run_pwm_led() {
+    print_metric("pwm_led.8bit.mismatches", pwm_mismatches<driver::PwmRgbLed<8>>(LEDC_TIMER_0, LEDC_CHANNEL_0), "checks");
+    print_metric("pwm_led.12bit.mismatches", pwm_mismatches<driver::PwmRgbLed<>>(LEDC_TIMER_1, LEDC_CHANNEL_3), "checks");
+    print_metric("pwm_led.16bit_1khz.mismatches",
+                 pwm_mismatches<driver::PwmRgbLed<16, 1000>>(LEDC_TIMER_2, LEDC_CHANNEL_0), "checks");
+}
+
+// === Driver object sizes ===
+// As the compiler lays them out for the host (64-bit); the chip's 32-bit layout
+// is smaller, check it with the target toolchain
+void run_sizes() {
+    print_metric("size.gpio", sizeof(driver::Gpio), "bytes");
+    print_metric("size.fixed_gpio", sizeof(driver::fixed::Gpio<GPIO_NUM_27>), "bytes");
+    print_metric("size.multi_color_led", sizeof(driver::MultiColorLed), "bytes");
+    print_metric("size.fixed_multi_color_led",
+                 sizeof(driver::fixed::MultiColorLed<GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25>), "bytes");
+    print_metric("size.fixed_led_adapter",
+                 sizeof(driver::fixed::LedAdapter<driver::fixed::SingleColorLed<GPIO_NUM_2>>), "bytes");
+}
+
+// === UltrasonicArray sweep rate ===
+void run_array() {
+    // Four sensors in a row, each hearing its neighbors: two firing groups
+    const std::vector<driver::UltrasonicArray::SensorPins> pins = {
+        {GPIO_NUM_18, GPIO_NUM_32}, {GPIO_NUM_19, GPIO_NUM_33},
+        {GPIO_NUM_21, GPIO_NUM_34}, {GPIO_NUM_22, GPIO_NUM_35},
+    };
+    const std::vector<uint32_t> crosstalk = {0b0010, 0b0101, 0b1010, 0b0100};
+
+    std::vector<std::unique_ptr<host::EchoModel>> echoes;
+    for (size_t i = 0; i < pins.size(); ++i) {
+        float distance = 60.0f + 20.0f * i;
+        echoes.push_back(std::make_unique<host::EchoModel>(
+            pins[i].trigger_pin, pins[i].echo_pin, [distance](int64_t) { return distance; }));
+    }
+
+    driver::UltrasonicArray array(pins, crosstalk);
+    driver::UltrasonicArray::Snapshot snapshot;
+
+    constexpr int SWEEPS = 50;
+    int64_t start_us = sim::now_us();
+    for (int i = 0; i < SWEEPS; ++i) {
+        array.sweep(snapshot);
+    }
+    double elapsed_s = (sim::now_us() - start_us) / 1e6;
+
+    print_metric("array.sensors", array.size(), "sensors");
+    print_metric("array.groups", array.group_count(), "groups");
+    print_metric("array.sweep_rate", SWEEPS / elapsed_s, "sweeps/s");
+
+    // Host CPU time per sweep, simulator overhead included
+    bench::Result cpu = bench::measure("array.sweep", 5, [&] { array.sweep(snapshot); }, 3);
+    print_metric("array.sweep_cpu", cpu.ns_per_op / 1e3, "host us");
+    // Reading the published sweep from another task must not touch the heap
+    bench::Result copy = bench::measure("array.latest_snapshot", 100,
+                                        [&] { bench::keep(array.latest_snapshot().sweep_id); });
+    print_metric("array.latest_snapshot_allocs", copy.allocs_per_op, "allocs/op");
+}
+
+// === Range-limited timeouts ===
+// Virtual time one call blocks for, starting with the module idle
+template <typename Fn>
+double call_latency_ms(Fn&& fn) {
+    app::sleep_ms(50);      // longer than the module's 38 ms no-target echo
+    int64_t start_us = sim::now_us();
+    fn();
+    return (sim::now_us() - start_us) / 1e3;
+}
+
+void run_timeouts() {
+    driver::UltrasonicSensor sensor(TRIGGER_PIN, ECHO_PIN, 30000,
+                                    driver::UltrasonicSensor::EchoMode::Interrupt);
+    float distance = 0.0f;
+    auto measure = [&] { sensor.measure_distance(distance); };
+    auto in_range = [&] { bench::keep(sensor.is_object_in_range(WARN_THRESHOLD_CM)); };
+
+    current_scene = empty_scene;
+    print_metric("timeout.no_target.default", call_latency_ms(measure), "ms");
+    print_metric("timeout.no_target.in_range_20cm", call_latency_ms(in_range), "ms");
+    sensor.set_max_range(100.0f);
+    print_metric("timeout.no_target.max_range_100cm", call_latency_ms(measure), "ms");
+
+    current_scene = far_scene;
+    sensor.set_timeout(30000);
+    print_metric("timeout.object_150cm.default", call_latency_ms(measure), "ms");
+    print_metric("timeout.object_150cm.in_range_20cm", call_latency_ms(in_range), "ms");
+
+    // Measuring right after an abort waits for the module to release the echo line
+    sensor.is_object_in_range(WARN_THRESHOLD_CM);
+    int64_t start_us = sim::now_us();
+    measure();
+    print_metric("timeout.object_150cm.after_abort", (sim::now_us() - start_us) / 1e3, "ms");
+    print_metric("timeout.object_150cm.after_abort_distance", distance, "cm");
+
+    // Echo line stuck high (wiring fault): one control step should give up after
+    // a single stuck-echo wait, not retry it through a blocking measurement
+    driver::MultiColorLed led(GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25,
+                              driver::Led::Configuration::CommonAnode);
+    app::ProximityLightingController controller(
+        led, sensor, app::ProximityLightingController::Config(WARN_THRESHOLD_CM, 10.0f, 50.0f, 200, 8));
+    app::sleep_ms(50);
+    sim::drive_pin(ECHO_PIN, 1);
+    start_us = sim::now_us();
+    controller.step();
+    print_metric("timeout.stuck_echo.step", (sim::now_us() - start_us) / 1e3, "ms");
+    sim::drive_pin(ECHO_PIN, 0);
+}
+
+// === Outlier rejection ===
+// Readings taken after a single spurious 5 cm echo in a steady 100 cm scene whose
+// zone differs from the steady one; should be 0 at any sampling period
+int outlier_zone_changes(int period_ms) {
+    driver::MultiColorLed led(GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25,
+                              driver::Led::Configuration::CommonAnode);
+    driver::UltrasonicSensor sensor(TRIGGER_PIN, ECHO_PIN);
+    app::ProximityLightingController controller(
+        led, sensor, app::ProximityLightingController::Config(WARN_THRESHOLD_CM, 10.0f, 50.0f, 200, 8));
+
+    constexpr int SETTLE = 20;
+    for (int i = 0; i < SETTLE; ++i) {
+        controller.update(100.0f);
+        app::sleep_ms(period_ms);
+    }
+    auto steady = controller.classify();
+
+    int changes = 0;
+    controller.update(5.0f);
+    for (int i = 0; i <= SETTLE; ++i) {
+        changes += controller.classify() != steady;
+        app::sleep_ms(period_ms);
+        controller.update(100.0f);
+    }
+    return changes;
+}
+
+void run_outliers() {
+    print_metric("outlier.zone_changes.period_60ms", outlier_zone_changes(60), "readings");
+    print_metric("outlier.zone_changes.period_500ms", outlier_zone_changes(500), "readings");
+}
+
+// === Adaptive sampling ===
+struct SceneResult {
+    double pings_per_s;
+    bool warned;                    // The LED showed Warning or Danger at some point
+    double warning_latency_ms;      // Only if warned; negative: warned before the object crossed the threshold
+};
+
+SceneResult run_scene(float (*scene)(int64_t), double seconds, double cross_s, bool adaptive,
+                      host::EchoModel& echo) {
+    driver::MultiColorLed led(GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25,
+                              driver::Led::Configuration::CommonAnode);
+    driver::UltrasonicSensor sensor(TRIGGER_PIN, ECHO_PIN, 30000,
+                                    driver::UltrasonicSensor::EchoMode::Interrupt);
+
+    app::ProximityLightingController::Config config(WARN_THRESHOLD_CM, 10.0f, 50.0f, 200, 8);
+    if (!adaptive) {
+        config.fast_rate_ms = config.idle_rate_ms = config.update_rate_ms;
+    }
+    app::ProximityLightingController controller(led, sensor, config);
+
+    current_scene = scene;
+    scene_start_us = sim::now_us();
+    warning_seen = false;
+    uint64_t pings_before = echo.pings();
+
+    int64_t end_us = scene_start_us + static_cast<int64_t>(seconds * 1e6);
+    while (sim::now_us() < end_us) {
+        app::sleep_ms(controller.step());
+    }
+
+    SceneResult result;
+    result.pings_per_s = (echo.pings() - pings_before) / seconds;
+    result.warned = warning_seen;
+    result.warning_latency_ms = warning_seen
+        ? (first_warning_us - scene_start_us) / 1e3 - cross_s * 1e3
+        : 0.0;
+    return result;
+}
+
+void run_sampling(host::EchoModel& echo) {
+    SceneResult clear_adaptive = run_scene(clear_scene, 30.0, 0.0, true, echo);
+    SceneResult clear_fixed = run_scene(clear_scene, 30.0, 0.0, false, echo);
+    print_metric("sampling.clear.adaptive", clear_adaptive.pings_per_s, "pings/s");
+    print_metric("sampling.clear.fixed", clear_fixed.pings_per_s, "pings/s");
+
+    // Nothing in range: every measurement times out
+    SceneResult empty_adaptive = run_scene(empty_scene, 30.0, 0.0, true, echo);
+    SceneResult empty_fixed = run_scene(empty_scene, 30.0, 0.0, false, echo);
+    print_metric("sampling.empty.adaptive", empty_adaptive.pings_per_s, "pings/s");
+    print_metric("sampling.empty.fixed", empty_fixed.pings_per_s, "pings/s");
+
+    double cross_s = APPROACH_START_S + (250.0f - WARN_THRESHOLD_CM) / APPROACH_SPEED_CM_S;
+    SceneResult approach_adaptive = run_scene(approach_scene, 10.0, cross_s, true, echo);
+    SceneResult approach_fixed = run_scene(approach_scene, 10.0, cross_s, false, echo);
+    print_metric("sampling.approach.adaptive", approach_adaptive.pings_per_s, "pings/s");
+    print_metric("sampling.approach.fixed", approach_fixed.pings_per_s, "pings/s");
+    print_metric("warned.approach.adaptive", approach_adaptive.warned, "bool");
+    print_metric("warned.approach.fixed", approach_fixed.warned, "bool");
+    // A scene that never warned has no latency; leave the row out rather than invent one
+    if (approach_adaptive.warned) {
+        print_metric("warning_latency.approach.adaptive", approach_adaptive.warning_latency_ms, "ms");
+    }
+    if (approach_fixed.warned) {
+        print_metric("warning_latency.approach.fixed", approach_fixed.warning_latency_ms, "ms");
+    }
+}
+
+} // namespace
+
+int main() {
+    host::EchoModel echo(TRIGGER_PIN, ECHO_PIN,
+                         [](int64_t time_us) { return current_scene(time_us - scene_start_us); });
+    watch_for_warning();
+
+    run_task("bench", run_suite);
+
+    printf("\nmetric,value,unit\n");
+    run_window_check();
+    run_sizes();
+    run_task("pwm_led", run_pwm_led);
+    run_task("array", run_array);
+    run_task("timeouts", run_timeouts);
+    run_task("outliers", run_outliers);
+    run_task("sampling", [&echo] { run_sampling(echo); });
+
+    // Simulated tasks may still be blocked; leave without running static destructors
+    fflush(stdout);
+    std::_Exit(0);
+}
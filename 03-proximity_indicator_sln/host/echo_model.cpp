@@ -0,0 +1,36 @@
+#include "echo_model.h"
+#include "sim/gpio.h"
+#include "sim/kernel.h"
+
+host::EchoModel::EchoModel(gpio_num_t trigger_pin, gpio_num_t echo_pin, Scene scene)
+    : echo_pin_(echo_pin), scene_(std::move(scene)) {
+    sim::watch_pin(trigger_pin, [this](int level) { on_trigger(level); });
+}
+
+uint64_t host::EchoModel::pings() const {
+    sim::Lock held = sim::lock();
+    return pings_;
+}
+
+void host::EchoModel::on_trigger(int level) {
+    // The module starts its burst on the trigger's falling edge
+    if (level != 0 || echo_busy_) {
+        return;
+    }
+    ++pings_;
+    echo_busy_ = true;
+
+    int64_t rise_us = sim::now_us() + BURST_DELAY_US;
+    float distance_cm = scene_(rise_us);
+
+    int64_t pulse_us = NO_ECHO_PULSE_US;
+    if (distance_cm > 0.0f && distance_cm <= MAX_RANGE_CM) {
+        pulse_us = static_cast<int64_t>(2.0f * distance_cm / SPEED_OF_SOUND_CM_PER_US);
+    }
+
+    sim::schedule_at(rise_us, [this]() { sim::drive_pin(echo_pin_, 1); });
+    sim::schedule_at(rise_us + pulse_us, [this]() {
+        sim::drive_pin(echo_pin_, 0);
+        echo_busy_ = false;
+    });
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include "driver/gpio.h"
+#include <cstdint>
+#include <functional>
+
+// Host model of an HC-SR04 wired to the simulator's GPIO matrix.
+//
+// Each trigger pulse from the firmware starts a ping: after the module's burst
+// delay the echo pin goes high for the round trip to whatever the scene puts in
+// front of the sensor. With nothing in range the module times out and holds the
+// echo high for NO_ECHO_PULSE_US, like the real part.
+namespace host {
+
+class EchoModel {
+public:
+    static constexpr float SPEED_OF_SOUND_CM_PER_US = 0.0343f;
+    static constexpr float MAX_RANGE_CM = 400.0f;
+    static constexpr int64_t BURST_DELAY_US = 450;      // 8-cycle 40 kHz burst + settling
+    static constexpr int64_t NO_ECHO_PULSE_US = 38000;
+
+    // Distance to the target (cm) at a virtual time (us); <= 0 or beyond
+    // MAX_RANGE_CM means nothing in range
+    using Scene = std::function<float(int64_t time_us)>;
+
+    EchoModel(gpio_num_t trigger_pin, gpio_num_t echo_pin, Scene scene);
+
+    uint64_t pings() const;
+
+private:
+    void on_trigger(int level);
+
+    gpio_num_t echo_pin_;
+    Scene scene_;
+    uint64_t pings_ = 0;
+    bool echo_busy_ = false;    // the module ignores triggers until its echo ends
+};
+
+} // namespace host
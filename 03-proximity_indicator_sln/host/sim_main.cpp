@@ -0,0 +1,159 @@
+// Runs the proximity indicator firmware on the host against a simulated scene.
+//
+// Usage: proximity_sim [--scene static|approach|empty] [--seconds N] [--quiet]
+//
+// The firmware's app_main() runs as a simulated task on a virtual clock, so a
+// 20 s scene finishes in a fraction of that. The runner watches the RGB LED's
+// LEDC channels and prints every color change with its virtual timestamp.
+#include "echo_model.h"
+#include "sim/kernel.h"
+#include "sim/ledc.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unistd.h>
+
+extern "C" void app_main();
+
+namespace {
+
+// Pins as wired in app_main()
+constexpr gpio_num_t TRIGGER_PIN = GPIO_NUM_16;
+constexpr gpio_num_t ECHO_PIN = GPIO_NUM_17;
+constexpr ledc_channel_t RED_CHANNEL = LEDC_CHANNEL_0;     // then green and blue
+constexpr int64_t LED_SAMPLE_US = 1000;
+
+// Object parked in the safe zone
+float static_scene(int64_t) {
+    return 35.0f;
+}
+
+// Nothing in front of the sensor for 2 s, then a wall at 150 cm that closes at
+// 40 cm/s down to 5 cm, holds for 2 s and backs off at the same speed
+float approach_scene(int64_t time_us) {
+    float t = time_us / 1e6f;
+    if (t < 2.0f) return 0.0f;
+    t -= 2.0f;
+    constexpr float START_CM = 150.0f, END_CM = 5.0f, SPEED_CM_S = 40.0f, HOLD_S = 2.0f;
+    constexpr float TRAVEL_S = (START_CM - END_CM) / SPEED_CM_S;
+    if (t < TRAVEL_S) return START_CM - SPEED_CM_S * t;
+    t -= TRAVEL_S;
+    if (t < HOLD_S) return END_CM;
+    t -= HOLD_S;
+    return t < TRAVEL_S ? END_CM + SPEED_CM_S * t : 0.0f;
+}
+
+float empty_scene(int64_t) {
+    return 0.0f;
+}
+
+// Decode the LED from its channel duties (polarity is inverted in the LEDC output)
+const char* led_color() {
+    auto lit = [](int offset) {
+        return sim::ledc_duty(LEDC_LOW_SPEED_MODE, static_cast<ledc_channel_t>(RED_CHANNEL + offset)) > 0;
+    };
+    bool red = lit(0);
+    bool green = lit(1);
+    bool blue = lit(2);
+    static const char* names[] = {"off", "blue", "green", "cyan", "red", "purple", "yellow", "white"};
+    return names[(red << 2) | (green << 1) | blue];
+}
+
+struct Options {
+    std::string scene = "approach";
+    double seconds = 20.0;
+    bool quiet = false;
+};
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--scene") == 0 && i + 1 < argc) {
+            options.scene = argv[++i];
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+            options.seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--quiet") == 0) {
+            options.quiet = true;
+        } else {
+            return false;
+        }
+    }
+    return options.seconds > 0.0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        fprintf(stderr, "usage: %s [--scene static|approach|empty] [--seconds N] [--quiet]\n", argv[0]);
+        return 2;
+    }
+
+    host::EchoModel::Scene scene;
+    if (options.scene == "static") scene = static_scene;
+    else if (options.scene == "approach") scene = approach_scene;
+    else if (options.scene == "empty") scene = empty_scene;
+    else {
+        fprintf(stderr, "unknown scene '%s'\n", options.scene.c_str());
+        return 2;
+    }
+
+    host::EchoModel sensor(TRIGGER_PIN, ECHO_PIN, scene);
+
+    // Color changes go to stderr so --quiet can silence the firmware's stdout.
+    // LEDC has no change callback, so the duties are sampled every millisecond
+    // of virtual time; a fade is reported once it has landed.
+    std::string last_color = "off";
+    uint64_t color_changes = 0;
+    std::function<void()> sample_led = [&]() {
+        std::string color = led_color();
+        if (color != last_color) {
+            fprintf(stderr, "[%9.3f s] LED %s\n", sim::now_us() / 1e6, color.c_str());
+            last_color = color;
+            ++color_changes;
+        }
+        sim::schedule_in(LED_SAMPLE_US, sample_led);
+    };
+    sim::schedule_in(LED_SAMPLE_US, sample_led);
+
+    // Keep firmware lines whole when they interleave with the LED trace
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    int saved_stdout = -1;
+    if (options.quiet) {
+        fflush(stdout);
+        saved_stdout = dup(STDOUT_FILENO);
+        if (!freopen("/dev/null", "w", stdout)) {
+            return 1;
+        }
+    }
+
+    auto wall_start = std::chrono::steady_clock::now();
+    sim::start_task("main", []() { app_main(); });
+    sim::run_until(static_cast<int64_t>(options.seconds * 1e6));
+    auto wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+
+    {
+        sim::Lock held = sim::lock();
+        fflush(stdout);
+        if (saved_stdout >= 0) {
+            dup2(saved_stdout, STDOUT_FILENO);
+        }
+
+        fprintf(stderr, "=== Simulation summary ===\n");
+        fprintf(stderr, "Scene: %s\n", options.scene.c_str());
+        fprintf(stderr, "Virtual time: %.3f s (wall %.1f ms)\n", sim::now_us() / 1e6, wall_ms);
+        fprintf(stderr, "Pings: %llu (%.1f per second)\n", static_cast<unsigned long long>(sensor.pings()),
+                sensor.pings() / options.seconds);
+        fprintf(stderr, "LED color changes: %llu, final color %s\n",
+                static_cast<unsigned long long>(color_changes), last_color.c_str());
+        fflush(stderr);
+
+        // Simulated tasks never return; leave without running static destructors
+        // under their feet
+        std::_Exit(0);
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include "trace.h"
+#include <cstdint>
+
+// Microbenchmarks for the driver and controller hot paths.
+//
+//     bench::print_header();
+//     bench::print(bench::measure("gpio.set_high", 1000, [&] { gpio.set_high(); }));
+//
+// measure() times several batches of calls with the CPU cycle counter and keeps
+// the fastest one, which filters out interrupts and task switches; the cost of an
+// empty loop is subtracted. Results print as CSV so runs can be diffed or plotted.
+//
+// On target, build with -DRUN_BENCHMARKS=1 (see platformio.ini) and capture the
+// serial output. The host build in host/ runs the same suite against simulated
+// peripherals; there "cycles" are host nanoseconds.
+
+#ifndef RUN_BENCHMARKS
+#define RUN_BENCHMARKS 0
+#endif
+
+namespace bench {
+
+struct Result {
+    const char* name;
+    uint32_t iterations;        // calls per batch
+    float cycles_per_op;        // fastest batch, loop overhead removed
+    float ns_per_op;
+    float allocs_per_op;        // heap allocations per call, negative if not counted
+};
+
+// Keep a value alive so the compiler cannot drop the work that produced it
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Heap allocation counter, installed by builds that can count (the host bench)
+using AllocationCounter = uint64_t (*)();
+void set_allocation_counter(AllocationCounter counter);
+
+// Batches per measurement
+constexpr uint32_t REPEATS = 5;
+
+// The logging rows: one DeferredLog capacity per batch, many batches
+constexpr uint32_t LOG_BATCH = 32;
+constexpr uint32_t LOG_REPEATS = 200;
+
+// Turn raw batch timings into a Result (defined in bench.cpp)
+Result make_result(const char* name, uint32_t iterations, uint32_t best_cycles,
+                   int64_t allocations, uint32_t batches);
+
+// Allocations so far, or -1 without a counter
+int64_t allocations();
+
+// Time fn() called iterations times per batch; reset() runs untimed after each
+// batch, e.g. to empty a buffer the benchmark fills
+template <typename Fn, typename Reset>
+Result measure_with_reset(const char* name, uint32_t iterations, Fn&& fn, Reset&& reset,
+                          uint32_t repeats = REPEATS) {
+    // Warm-up: lazy initialization, caches, branch predictors
+    fn();
+    reset();
+
+    uint32_t best = UINT32_MAX;
+    int64_t allocs_before = allocations();
+    for (uint32_t r = 0; r < repeats; ++r) {
+        uint32_t start = util::trace::cycles();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        uint32_t elapsed = util::trace::cycles() - start;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+        reset();
+    }
+    int64_t allocs_after = allocations();
+
+    int64_t allocs = allocs_before < 0 ? -1 : allocs_after - allocs_before;
+    return make_result(name, iterations, best, allocs, repeats);
+}
+
+template <typename Fn>
+Result measure(const char* name, uint32_t iterations, Fn&& fn, uint32_t repeats = REPEATS) {
+    return measure_with_reset(name, iterations, fn, [] {}, repeats);
+}
+
+void print_header();
+void print(const Result& result);
+
+// Run the driver and controller suite and print it as CSV. Uses the pins wired
+// in app_main(); measure_distance_avg needs the sensor (or the host echo model).
+void run_all();
+
+} // namespace bench
@@ -0,0 +1,179 @@
+#pragma once
+#include "ring_buffer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+// Queue a DeferredLog record after checking at compile time that the format's
+// conversions match the arguments (see DeferredLog::FormatCheck). format must be
+// a string literal.
+#define DEFERRED_LOG(logger, format, ...)                                                   \
+    do {                                                                                    \
+        static_assert(decltype(util::DeferredLog::arg_types(__VA_ARGS__))::matches(format), \
+                      "log arguments do not match the format");                             \
+        (logger).log(format, ##__VA_ARGS__);                                                \
+    } while (0)
+
+namespace util {
+
+// printf-style logging that defers the formatting. log() only copies the format
+// pointer and the raw argument words into a ring buffer; drain() (usually from a
+// low-priority task) formats and prints them later, off the hot path.
+//
+// Log through DEFERRED_LOG, which rejects a format that does not match its
+// arguments at compile time; drain() would otherwise hand snprintf the wrong type.
+//
+// Rules for callers:
+//   - format must be a string literal (its address is stored, not its text)
+//   - up to MAX_ARGS arguments: integers (at most 32 bits are kept), floats,
+//     and const char* that stay valid forever (literals)
+//   - one task produces records; do not log from ISRs
+class DeferredLog {
+public:
+    static constexpr size_t MAX_ARGS = 8;
+    static constexpr size_t CAPACITY = 32;  // records buffered before new ones are dropped
+
+    union Arg {
+        int32_t i;
+        uint32_t u;
+        float f;
+        const char* s;
+    };
+
+    // Source of record timestamps, in us
+    using Clock = int64_t (*)();
+
+    struct Record {
+        const char* format;
+        int64_t timestamp_us;
+        uint8_t arg_count;
+        char types[MAX_ARGS];   // 'i', 'u', 'f' or 's' per argument
+        Arg args[MAX_ARGS];
+    };
+
+    // Timestamps come from esp_timer unless another clock is given
+    explicit DeferredLog(Clock clock = &now_us) : clock_(clock) {}
+
+    // Queue a message; returns false (and counts a drop) if the buffer is full
+    template <typename... Args>
+    bool log(const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= MAX_ARGS, "too many log arguments");
+
+        Record record;
+        record.format = format;
+        record.timestamp_us = clock_();
+        record.arg_count = sizeof...(Args);
+        size_t index = 0;
+        (pack(record, index++, args), ...);
+
+        if (!records_.push(record)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // Format and print up to max_records queued records; returns how many were printed
+    size_t drain(size_t max_records = CAPACITY);
+
+    // Drain from a background task every period_ms
+    bool start_drain_task(UBaseType_t priority = 1, uint32_t period_ms = 50);
+
+    // Records lost because the buffer was full
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Compile-time check of a format against the argument types Args. Each
+    // argument needs one conversion of its kind: d i u x X c for integers and
+    // enums, f F e E g G for floats, s for strings. Flags, width and precision are
+    // fine; '*' and length modifiers are not, as every argument is kept in 32 bits.
+    template <typename... Args>
+    struct FormatCheck {
+        static constexpr bool matches(const char* format) {
+            const char tags[] = {tag<Args>()..., '\0'};
+            size_t arg = 0;
+            for (const char* p = format; *p != '\0'; ++p) {
+                if (*p != '%') {
+                    continue;
+                }
+                if (*++p == '%') {
+                    continue;
+                }
+                while (is_one_of(*p, "-+ #0123456789.")) {
+                    ++p;
+                }
+                char expected = conversion_tag(*p);
+                if (expected == '\0' || arg == sizeof...(Args) || kind(tags[arg]) != expected) {
+                    return false;
+                }
+                ++arg;
+            }
+            return arg == sizeof...(Args);
+        }
+    };
+
+    // For DEFERRED_LOG: the FormatCheck of a call's arguments (unevaluated)
+    template <typename... Args>
+    static FormatCheck<std::decay_t<Args>...> arg_types(const Args&...);
+
+private:
+    RingBuffer<Record, CAPACITY> records_;
+    std::atomic<uint32_t> dropped_{0};
+    uint32_t drain_period_ms_ = 50;
+    Clock clock_;
+
+    static int64_t now_us();
+    static void print(const Record& record);
+    static void drain_task(void* arg);
+
+    // Type tag of an argument: 'i', 'u', 'f' or 's'
+    template <typename T>
+    static constexpr char tag() {
+        if constexpr (std::is_floating_point_v<T>) {
+            return 'f';
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            return 'i';
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            return 'u';
+        } else {
+            static_assert(std::is_convertible_v<T, const char*>, "unsupported log argument type");
+            return 's';
+        }
+    }
+
+    template <typename T>
+    static void pack(Record& record, size_t index, T value) {
+        Arg& arg = record.args[index];
+        record.types[index] = tag<T>();
+        if constexpr (std::is_floating_point_v<T>) {
+            arg.f = static_cast<float>(value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            arg.i = static_cast<int32_t>(value);
+        } else if constexpr (std::is_integral_v<T> || std::is_enum_v<T>) {
+            arg.u = static_cast<uint32_t>(value);
+        } else {
+            arg.s = value;
+        }
+    }
+
+    // Integers match any integer conversion, signed or not
+    static constexpr char kind(char tag) { return tag == 'u' ? 'i' : tag; }
+
+    // Tag a conversion character takes, '\0' if drain() does not support it
+    static constexpr char conversion_tag(char c) {
+        return is_one_of(c, "diuxXc") ? 'i' : is_one_of(c, "fFeEgG") ? 'f' : c == 's' ? 's' : '\0';
+    }
+
+    static constexpr bool is_one_of(char c, const char* set) {
+        for (; c != '\0' && *set != '\0'; ++set) {
+            if (*set == c) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+} // namespace util
@@ -1,5 +1,7 @@
 #pragma once
 #include "driver/gpio.h"
+#include <cstdint>
+#include <initializer_list>
 
 namespace driver {
 
@@ -18,6 +20,7 @@ public:
     void set_low();
     void toggle();
     bool read() const;
+    gpio_num_t pin() const { return pin_; }
 
 private:
     gpio_num_t pin_;
@@ -27,6 +30,34 @@ private:
 };
 
 
+// === GPIO port ===
+// Several output pins driven together. Writes go straight to the W1TS/W1TC
+// registers of GPIO bank 0 (GPIO0-31) and bank 1 (GPIO32-39), so any combination
+// of pins changes without a read-modify-write: one store per bank and direction,
+// at most two when every pin is in the same bank. Masks hold bit n for GPIOn.
+class GpioPort {
+public:
+    // configures every pin with a single gpio_config call
+    GpioPort(std::initializer_list<gpio_num_t> pins,
+             gpio_mode_t mode = GPIO_MODE_OUTPUT);
+
+    // bit mask of one pin, for building set/clear masks
+    static constexpr uint64_t pin_mask(gpio_num_t pin) { return 1ULL << pin; }
+
+    // basic operations (masks are limited to the port's pins)
+    void set(uint64_t mask);
+    void clear(uint64_t mask);
+    // a pin in both masks is set, and is never driven through the cleared level
+    void write(uint64_t set_mask, uint64_t clear_mask);
+    void toggle(uint64_t mask);
+    uint64_t read() const;
+    uint64_t mask() const { return mask_; }
+
+private:
+    uint64_t mask_;
+};
+
+
 // === LED base class ===
 class Led {
 public:
@@ -41,10 +72,23 @@ public:
     virtual ~Led() = default;
 
 protected:
+    explicit Led(Configuration config) : config_(config) {}
+
     Configuration config_;
 };
 
 
+// === RGB led interface ===
+// What a color indicator needs, whether the channels are plain GPIOs or PWM
+class ColorLed : public Led {
+public:
+    virtual void set_color(bool red, bool green, bool blue) = 0;
+
+protected:
+    explicit ColorLed(Configuration config) : Led(config) {}
+};
+
+
 // === single-color led ===
 class SingleColorLed : public Led {
 public:
@@ -60,7 +104,9 @@ private:
 
 
 // === multi-color led (RGB) ===
-class MultiColorLed : public Led {
+// All three channels share one GpioPort, so a color change is a single
+// set/clear register write instead of one gpio_set_level call per channel.
+class MultiColorLed : public ColorLed {
 public:
     MultiColorLed(gpio_num_t red_pin, gpio_num_t green_pin, gpio_num_t blue_pin,
                   Configuration config = Configuration::CommonCathode);
@@ -68,12 +114,13 @@ public:
     void on() override;
     void off() override;
     void toggle() override;
-    void set_color(bool red, bool green, bool blue);
+    void set_color(bool red, bool green, bool blue) override;
 
 private:
-    SingleColorLed red_;
-    SingleColorLed green_;
-    SingleColorLed blue_;
+    uint64_t red_mask_;
+    uint64_t green_mask_;
+    uint64_t blue_mask_;
+    GpioPort port_;
 };
 
 } // namespace driver
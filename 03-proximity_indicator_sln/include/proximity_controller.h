@@ -0,0 +1,296 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "led.h"
+#include "ultrasonic.h"
+#include "window_stats.h"
+#include "range_tracker.h"
+#include "deferred_log.h"
+#include "trace.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+
+namespace app {
+
+inline void sleep_ms(int ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+class ProximityLightingController {
+public:
+    // Largest history the controller can keep (Config::history_size is clamped to it)
+    static constexpr size_t MAX_HISTORY = 64;
+
+    // Configuration structure
+    // You can have a struct within a class!
+    // This is a good way to group related settings.
+    // I chose to do it here to keep the main controller class cleaner.
+    struct Config {
+        float warn_threshold_cm;
+        float danger_threshold_cm;
+        float safe_threshold_cm;
+        int update_rate_ms;
+        size_t history_size;
+
+        // Approach warnings: flag a zone early if the tracked object will reach
+        // its threshold within this many seconds at the current closing speed
+        float danger_time_to_collision_s = 1.0f;
+        float warn_time_to_collision_s = 2.0f;
+        // An approach alone raises the zone only after this many readings in a row
+        uint32_t approach_confirm_samples = 3;
+
+        // Adaptive sampling: update_rate_ms is the nominal period. The controller
+        // speeds up to fast_rate_ms near an object or while the distance is changing,
+        // and slows toward idle_rate_ms when the scene is clear and stable. The idle
+        // period is capped so that an object closing at max_approach_speed_cm_s
+        // cannot reach the warn threshold between two samples.
+        int fast_rate_ms = 60;                  // HC-SR04 minimum measurement cycle
+        int idle_rate_ms = 1000;
+        float max_approach_speed_cm_s = 150.0f;
+        float moving_speed_cm_s = 10.0f;        // faster than this counts as changing
+        float stable_stddev_cm = 1.0f;          // window spread below this counts as stable
+              
+        // parameterized constructor
+        // TODO: write the constructor for Config that takes in the arguments as in the main function,
+        // and assigns them to the member variables.
+        Config(float warn, float danger, float safe, int rate, size_t hist_size)
+            : warn_threshold_cm(warn), danger_threshold_cm(danger), 
+              safe_threshold_cm(safe), update_rate_ms(rate),
+              history_size(hist_size) {}
+    };
+
+    // Proximity zones, most severe first
+    enum class Zone { Danger, Warning, Safe, Clear };
+
+    // Constructor for the controller. Any RGB LED works: MultiColorLed switches
+    // GPIOs, PwmRgbLed fades between zone colors in the LEDC hardware.
+    ProximityLightingController(driver::ColorLed& led, driver::UltrasonicSensor& sensor, const Config& cfg)
+        : led_(led), sensor_(sensor), cfg_(cfg),
+          distance_history_(std::min(cfg.history_size, MAX_HISTORY)) {
+        cfg_.history_size = distance_history_.window();
+    }
+
+    void run() {
+        printf("Starting ProximityLightingController...\n");
+        print_configuration();
+
+        // Diagnostics are formatted and printed by a low-priority task
+        log_.start_drain_task();
+
+        while (true) {
+            sleep_ms(step());
+        }
+    }
+
+    // One control-loop iteration: measure, update state, set the LED.
+    // Returns how long to sleep before the next one.
+    int step() {
+        TRACE_SCOPE("controller.iteration");
+
+        float distance_cm{};
+
+        // Fire the sensor and sleep while the echo is in flight; the log drain
+        // task uses that time to print earlier diagnostics
+        auto status = sensor_.start_measurement();
+
+        // TODO: call the measure_distance method and store the result in a variable named status
+        // (only sensors without the echo interrupt fall back to a blocking measurement;
+        // in Interrupt mode a failed start is a stuck echo line, which would just fail again)
+        if (status == driver::UltrasonicSensor::Status::Success) {
+            status = sensor_.wait_measurement(distance_cm);
+        } else if (sensor_.get_echo_mode() == driver::UltrasonicSensor::EchoMode::Polling) {
+            status = sensor_.measure_distance(distance_cm);
+        }
+
+        if (status != driver::UltrasonicSensor::Status::Success) {
+            // Set error color (purple)
+            show_color(true, false, true);
+            return failure_period_ms(status);
+        }
+
+        timeout_streak_ = 0;
+        return update(distance_cm);
+    }
+
+    // Feed one successful reading through the history and tracker, then set the LED.
+    // Returns how long to sleep before the next reading.
+    int update(float distance_cm) {
+        // Store measurement in history
+        // TODO: push the distance_cm to the distance_history_ window
+        // (it drops the oldest entry once cfg_.history_size samples are stored)
+        {
+            TRACE_SCOPE("controller.history");
+            distance_history_.push(distance_cm);
+        }
+
+        // Track range and closing speed; restart the track after a long gap
+        int64_t now_us = esp_timer_get_time();
+        float dt_s = (now_us - last_sample_us_) / 1e6f;
+        if (dt_s > MAX_TRACK_GAP_S) {
+            tracker_.reset();
+            recent_count_ = 0;
+        }
+        last_sample_us_ = now_us;
+
+        // The tracker sees the median of the last three readings, so a single
+        // spurious echo never reaches its velocity estimate
+        recent_cm_[recent_next_] = distance_cm;
+        recent_next_ = (recent_next_ + 1) % recent_cm_.size();
+        recent_count_ = std::min(recent_count_ + 1, recent_cm_.size());
+        if (recent_count_ == recent_cm_.size()) {
+            tracker_.update(median3(recent_cm_[0], recent_cm_[1], recent_cm_[2]), dt_s);
+        }
+        approach_streak_ = zone_for_approach() != Zone::Clear ? approach_streak_ + 1 : 0;
+
+        // Set LED color from the more severe of the filtered distance and the
+        // predicted approach, so a fast object is flagged before it arrives
+        Zone zone = classify();
+        set_led_for_zone(zone);
+
+        float speed = tracker_.velocity() < 0.0f ? -tracker_.velocity() : tracker_.velocity();
+        bool stable = distance_history_.stddev() <= cfg_.stable_stddev_cm;
+        int period_ms = sample_period_ms(zone, speed, stable, distance_history_.median());
+
+        // Diagnostics
+        print_diagnostics(distance_cm, zone, period_ms);
+        return period_ms;
+    }
+
+    // Current zone: the more severe of the filtered distance and the approach
+    // prediction, once the approach has held for approach_confirm_samples readings
+    Zone classify() const {
+        Zone approach = approach_streak_ >= cfg_.approach_confirm_samples ? zone_for_approach() : Zone::Clear;
+        return std::min(zone_for_distance(distance_history_.median()), approach);
+    }
+
+private:
+    driver::ColorLed& led_;
+    driver::UltrasonicSensor& sensor_;
+    Config cfg_;
+    
+    // Fixed-capacity distance history with streaming statistics,
+    // no heap allocation in the control loop
+    util::WindowStats<MAX_HISTORY> distance_history_;
+
+    // Range and closing-speed estimate for approach warnings
+    util::RangeTracker tracker_;
+
+    // Deferred diagnostics, keeps UART formatting out of the control loop
+    util::DeferredLog log_;
+
+    // Samples further apart than this do not describe one approach
+    static constexpr float MAX_TRACK_GAP_S = 1.0f;
+    int64_t last_sample_us_ = 0;    // Time of the last successful reading
+
+    // Last three readings, whose median feeds the tracker
+    std::array<float, 3> recent_cm_{};
+    size_t recent_next_ = 0;
+    size_t recent_count_ = 0;
+
+    // Readings in a row for which the tracker predicted an approach
+    uint32_t approach_streak_ = 0;
+
+    // Measurements in a row that heard no echo at all
+    static constexpr uint32_t EMPTY_SCENE_TIMEOUTS = 3;
+    uint32_t timeout_streak_ = 0;
+
+    static float median3(float a, float b, float c) {
+        return std::max(std::min(a, b), std::min(std::max(a, b), c));
+    }
+
+    // Color on the LED as red/green/blue bits, none yet: 0xFF
+    uint8_t shown_color_ = 0xFF;
+
+    Zone zone_for_distance(float distance) const {
+        if (distance < cfg_.danger_threshold_cm) return Zone::Danger;
+        if (distance < cfg_.warn_threshold_cm) return Zone::Warning;
+        if (distance < cfg_.safe_threshold_cm) return Zone::Safe;
+        return Zone::Clear;
+    }
+
+    Zone zone_for_approach() const {
+        if (tracker_.time_to_reach(cfg_.danger_threshold_cm) < cfg_.danger_time_to_collision_s) return Zone::Danger;
+        if (tracker_.time_to_reach(cfg_.warn_threshold_cm) < cfg_.warn_time_to_collision_s) return Zone::Warning;
+        return Zone::Clear;
+    }
+
+    // Sampling period for the next measurement, see Config for the policy.
+    // range_cm: nearest the object can be, which limits how long it is safe to wait.
+    int sample_period_ms(Zone zone, float speed, bool stable, float range_cm) const {
+        if (zone == Zone::Danger || zone == Zone::Warning || speed > cfg_.moving_speed_cm_s) {
+            return cfg_.fast_rate_ms;
+        }
+
+        int period_ms = (zone == Zone::Clear && stable) ? cfg_.idle_rate_ms : cfg_.update_rate_ms;
+
+        // Never wait longer than a worst-case approach needs to reach the warn zone
+        float headroom_cm = range_cm - cfg_.warn_threshold_cm;
+        int headroom_ms = static_cast<int>(headroom_cm * 1000.0f / cfg_.max_approach_speed_cm_s);
+
+        return std::max(std::min(period_ms, headroom_ms), cfg_.fast_rate_ms);
+    }
+
+    // Sampling period after a failed measurement. A few timeouts in a row mean
+    // nothing is within the sensor's range: a clear, stable scene, as far as the
+    // nearest possible object allows. Other errors keep the nominal rate.
+    int failure_period_ms(driver::UltrasonicSensor::Status status) {
+        if (status != driver::UltrasonicSensor::Status::Timeout) {
+            timeout_streak_ = 0;
+            return cfg_.update_rate_ms;
+        }
+        if (++timeout_streak_ < EMPTY_SCENE_TIMEOUTS) {
+            return cfg_.update_rate_ms;
+        }
+        return sample_period_ms(Zone::Clear, 0.0f, true, sensor_.get_max_range());
+    }
+
+    void set_led_for_zone(Zone zone) {
+        switch (zone) {
+            case Zone::Danger:  show_color(true, false, false); break;  // Red - danger
+            case Zone::Warning: show_color(true, true, false);  break;  // Yellow - warning
+            case Zone::Safe:    show_color(false, true, false); break;  // Green - safe
+            case Zone::Clear:   show_color(false, false, true); break;  // Blue - clear
+        }
+    }
+
+    // Only touch the LED when the color changes, so a running fade is not restarted
+    void show_color(bool red, bool green, bool blue) {
+        uint8_t color = (red << 2) | (green << 1) | blue;
+        if (color != shown_color_) {
+            led_.set_color(red, green, blue);
+            shown_color_ = color;
+        }
+    }
+
+    const char* get_zone_description(Zone zone) const {
+        switch (zone) {
+            case Zone::Danger:  return "Danger";
+            case Zone::Warning: return "Warning";
+            case Zone::Safe:    return "Safe";
+            case Zone::Clear:   return "Clear";
+        }
+        return "Unknown";
+    }
+
+    void print_diagnostics(float distance, Zone zone, int period_ms) {
+        TRACE_SCOPE("controller.log");
+        DEFERRED_LOG(log_, "Distance:%.1f cm | median %.1f | mean %.1f +/- %.2f | closing %.1f cm/s | next %d ms | %s",
+                     distance, distance_history_.median(), distance_history_.mean(), distance_history_.stddev(),
+                     -tracker_.velocity(), period_ms, get_zone_description(zone));
+    }
+
+    void print_configuration() {
+        printf("=== Configuration ===\n");
+        printf("Danger threshold: %.1f cm\n", cfg_.danger_threshold_cm);
+        printf("Warning threshold: %.1f cm\n", cfg_.warn_threshold_cm);
+        printf("Safe threshold: %.1f cm\n", cfg_.safe_threshold_cm);
+        printf("Update rate: %d ms (adaptive %d-%d ms)\n",
+               cfg_.update_rate_ms, cfg_.fast_rate_ms, cfg_.idle_rate_ms);
+        printf("Danger time-to-collision: %.1f s\n", cfg_.danger_time_to_collision_s);
+        printf("Warning time-to-collision: %.1f s\n", cfg_.warn_time_to_collision_s);
+        printf("History size: %u\n", static_cast<unsigned>(cfg_.history_size));
+        printf("===================\n");
+    }
+};
+
+} // namespace app
@@ -0,0 +1,105 @@
+#pragma once
+#include "led.h"  // For Led base class
+#include "driver/ledc.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace driver {
+
+// === gamma correction ===
+// Maps an 8-bit perceptual brightness to a linear PWM duty using the CIE 1931
+// lightness curve, so equal steps in input look like equal steps in brightness.
+// Built at compile time for any duty resolution.
+template <uint32_t DutyBits>
+constexpr std::array<uint16_t, 256> make_gamma_table() {
+    static_assert(DutyBits >= 8 && DutyBits <= 16, "duty resolution must be 8-16 bits");
+
+    std::array<uint16_t, 256> table{};
+    constexpr double max_duty = static_cast<double>((1UL << DutyBits) - 1);
+    for (size_t i = 0; i < table.size(); ++i) {
+        double lightness = i * 100.0 / 255.0;    // L* in 0..100
+        double luminance = lightness <= 8.0
+            ? lightness / 903.3
+            : ((lightness + 16.0) / 116.0) * ((lightness + 16.0) / 116.0) * ((lightness + 16.0) / 116.0);
+        table[i] = static_cast<uint16_t>(luminance * max_duty + 0.5);
+    }
+    return table;
+}
+
+
+// === PWM multi-color led (RGB) ===
+// RGB LED on three LEDC channels sharing one timer. Colors are 8 bits per channel,
+// gamma-corrected to the timer's duty resolution, and fades run in the LEDC
+// hardware so the CPU is free once a fade has been started. PwmRgbLed below picks
+// the resolution; this base holds the channel logic for all of them.
+class PwmRgbLedBase : public ColorLed {
+public:
+    using GammaTable = std::array<uint16_t, 256>;
+
+    // Led interface: on() restores the last color (white if none), off() goes dark
+    void on() override;
+    void off() override;
+    void toggle() override;
+
+    // Same on/off color interface as MultiColorLed, at full brightness. Fades
+    // over the color fade time set below, so a caller changing colors never
+    // steps the transition itself.
+    void set_color(bool red, bool green, bool blue) override;
+
+    // Hardware fade time for set_color() (0, the default, switches at once)
+    void set_color_fade_ms(uint32_t fade_ms);
+
+    // Set an 8-bit-per-channel color immediately (cancels a running fade)
+    void set_rgb(uint8_t red, uint8_t green, uint8_t blue);
+
+    // Fade to a color over duration_ms in hardware; returns without waiting
+    void fade_to_rgb(uint8_t red, uint8_t green, uint8_t blue, uint32_t duration_ms);
+
+protected:
+    // Uses first_channel and the two channels after it
+    PwmRgbLedBase(gpio_num_t red_pin, gpio_num_t green_pin, gpio_num_t blue_pin,
+                  Configuration config, ledc_timer_t timer, ledc_channel_t first_channel,
+                  ledc_timer_bit_t resolution, uint32_t frequency_hz, const GammaTable& gamma);
+
+private:
+    static constexpr size_t CHANNEL_COUNT = 3;
+    static constexpr ledc_mode_t SPEED_MODE = LEDC_LOW_SPEED_MODE;
+
+    const GammaTable& gamma_;
+    std::array<ledc_channel_t, CHANNEL_COUNT> channels_;
+    std::array<uint8_t, CHANNEL_COUNT> color_;   // Last requested color
+    bool lit_;
+    uint32_t color_fade_ms_ = 0;
+
+    void apply(const std::array<uint8_t, CHANNEL_COUNT>& rgb, uint32_t fade_ms);
+};
+
+// LEDC timers count the 80 MHz APB clock, so frequency * 2^DutyBits must stay
+// below it: at most 19.5 kHz at 12 bits, 1.2 kHz at 16
+constexpr uint32_t LEDC_SOURCE_CLOCK_HZ = 80000000;
+
+// PWM RGB LED with a duty resolution of DutyBits (8-16) at FrequencyHz; the gamma
+// table is built for that resolution at compile time
+template <uint32_t DutyBits = 12, uint32_t FrequencyHz = 5000>
+class PwmRgbLed : public PwmRgbLedBase {
+    static_assert(DutyBits >= 8 && DutyBits <= 16, "duty resolution must be 8-16 bits");
+    static_assert(FrequencyHz > 0 && (static_cast<uint64_t>(FrequencyHz) << DutyBits) <= LEDC_SOURCE_CLOCK_HZ,
+                  "PWM frequency too high for this duty resolution");
+
+public:
+    static constexpr uint32_t DUTY_BITS = DutyBits;
+    static constexpr uint32_t FREQUENCY_HZ = FrequencyHz;
+
+    // Perceptual 8-bit brightness -> duty at DutyBits
+    static constexpr GammaTable GAMMA_TABLE = make_gamma_table<DutyBits>();
+
+    PwmRgbLed(gpio_num_t red_pin, gpio_num_t green_pin, gpio_num_t blue_pin,
+              Configuration config = Configuration::CommonCathode,
+              ledc_timer_t timer = LEDC_TIMER_0,
+              ledc_channel_t first_channel = LEDC_CHANNEL_0)
+        : PwmRgbLedBase(red_pin, green_pin, blue_pin, config, timer, first_channel,
+                        static_cast<ledc_timer_bit_t>(DutyBits), FrequencyHz, GAMMA_TABLE) {}
+};
+
+} // namespace driver
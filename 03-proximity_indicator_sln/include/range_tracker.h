@@ -0,0 +1,46 @@
+#pragma once
+#include <cstdint>
+
+namespace util {
+
+// Alpha-beta tracker for a single range measurement. Estimates the range to an
+// object and how fast it is changing from noisy samples, so the application can
+// react to an approach before the raw distance crosses a threshold.
+// Single-precision only: one update is a handful of FPU multiply-adds.
+class RangeTracker {
+public:
+    // alpha: how much of each residual goes into the range (0..1)
+    // beta:  how much of each residual goes into the velocity (0..2, smaller = smoother)
+    explicit RangeTracker(float alpha = 0.5f, float beta = 0.2f);
+
+    // Feed a new measurement taken dt_s seconds after the previous one
+    void update(float measured_cm, float dt_s);
+
+    // Forget the track, e.g. after a long gap in the samples
+    void reset();
+
+    bool is_tracking() const;
+
+    // Filtered range in cm
+    float range() const;
+
+    // Rate of change in cm/s; negative means the object is approaching
+    float velocity() const;
+
+    // Range expected dt_s seconds from the last update
+    float predict(float dt_s) const;
+
+    // Seconds until the range reaches threshold_cm at the current closing speed.
+    // 0 if already inside it, a very large value if the object is not approaching
+    // or there is no track yet.
+    float time_to_reach(float threshold_cm) const;
+
+private:
+    float alpha_;
+    float beta_;
+    float range_cm_;
+    float velocity_cm_s_;
+    uint32_t samples_;      // 0 = no track, 1 = range only, 2+ = range and velocity
+};
+
+} // namespace util
@@ -0,0 +1,72 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace util {
+
+// Fixed-capacity FIFO with storage inside the object, so it never touches the heap.
+// Safe for one producer and one consumer running concurrently (e.g. an ISR or the
+// other core pushing, a task popping) without locks: the producer only writes
+// head_, the consumer only writes tail_.
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // === producer side ===
+    // Returns false (and drops the value) if the buffer is full
+    bool push(const T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) == N) {
+            return false;
+        }
+        items_[head & (N - 1)] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // === consumer side ===
+    // Returns false if the buffer is empty
+    bool pop(T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = items_[tail & (N - 1)];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Drop the oldest element, if any
+    bool pop() {
+        T discarded;
+        return pop(discarded);
+    }
+
+    // Element i counted from the oldest (0) to the newest (size() - 1)
+    const T& operator[](size_t i) const {
+        return items_[(tail_.load(std::memory_order_relaxed) + i) & (N - 1)];
+    }
+
+    // Most recently pushed element; only valid when not empty
+    const T& back() const {
+        return items_[(head_.load(std::memory_order_acquire) - 1) & (N - 1)];
+    }
+
+    // === either side ===
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() == N; }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    std::array<T, N> items_{};
+    std::atomic<size_t> head_{0};   // Next slot to write (producer)
+    std::atomic<size_t> tail_{0};   // Next slot to read (consumer)
+};
+
+} // namespace util
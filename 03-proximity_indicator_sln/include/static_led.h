@@ -0,0 +1,175 @@
+#pragma once
+#include "led.h"  // For Led::Configuration
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include <cstdint>
+
+// Compile-time variants of the GPIO and LED drivers in led.h.
+// Pins, masks and polarity are template parameters, so objects hold no state,
+// there are no virtual calls, and writing an input pin or splitting RGB pins
+// across banks fails to compile. No speed or size gain over the runtime classes
+// has been measured on the chip; on the host bench, where the simulated register
+// access dominates, they are no faster. Use these where the wiring is fixed at
+// build time; wrap one in LedAdapter when code needs the runtime driver::Led
+// interface.
+namespace driver::fixed {
+
+// === GPIO direction tags ===
+struct Output { static constexpr gpio_mode_t mode = GPIO_MODE_OUTPUT; };
+struct Input  { static constexpr gpio_mode_t mode = GPIO_MODE_INPUT;  };
+
+
+// === GPIO ===
+template <gpio_num_t Pin, typename Direction = Output>
+class Gpio {
+    static_assert(Pin >= 0 && Pin < GPIO_NUM_MAX, "invalid GPIO number");
+
+public:
+    // GPIO0-31 live in bank 0, GPIO32-39 in bank 1
+    static constexpr bool high_bank = Pin >= 32;
+    static constexpr uint32_t mask = 1UL << (Pin % 32);
+
+    Gpio() {
+        gpio_config_t cfg = {};
+        cfg.pin_bit_mask = 1ULL << Pin;
+        cfg.mode = Direction::mode;
+        cfg.pull_up_en = GPIO_PULLUP_DISABLE;
+        cfg.pull_down_en = GPIO_PULLDOWN_DISABLE;
+        cfg.intr_type = GPIO_INTR_DISABLE;
+        gpio_config(&cfg);
+    }
+
+    // basic operations
+    static void set_high() {
+        static_assert(Direction::mode == GPIO_MODE_OUTPUT, "set_high() on an input pin");
+        REG_WRITE(high_bank ? GPIO_OUT1_W1TS_REG : GPIO_OUT_W1TS_REG, mask);
+    }
+
+    static void set_low() {
+        static_assert(Direction::mode == GPIO_MODE_OUTPUT, "set_low() on an input pin");
+        REG_WRITE(high_bank ? GPIO_OUT1_W1TC_REG : GPIO_OUT_W1TC_REG, mask);
+    }
+
+    static void toggle() {
+        if (REG_READ(high_bank ? GPIO_OUT1_REG : GPIO_OUT_REG) & mask)
+            set_low();
+        else
+            set_high();
+    }
+
+    static bool read() {
+        return REG_READ(high_bank ? GPIO_IN1_REG : GPIO_IN_REG) & mask;
+    }
+};
+
+
+// === LED base class (CRTP) ===
+// Derived classes provide on(), off() and toggle(); the base adds helpers on top
+// without any virtual dispatch.
+template <typename Derived>
+class LedBase {
+public:
+    void set(bool lit) {
+        if (lit)
+            self().on();
+        else
+            self().off();
+    }
+
+protected:
+    Derived& self() { return static_cast<Derived&>(*this); }
+};
+
+
+// === single-color led ===
+template <gpio_num_t Pin, Led::Configuration Config = Led::Configuration::CommonCathode>
+class SingleColorLed : public LedBase<SingleColorLed<Pin, Config>> {
+    using PinGpio = Gpio<Pin, Output>;
+    static constexpr bool active_high = Config == Led::Configuration::CommonCathode;
+
+public:
+    static constexpr Led::Configuration configuration = Config;
+
+    void on()     { active_high ? PinGpio::set_high() : PinGpio::set_low(); }
+    void off()    { active_high ? PinGpio::set_low() : PinGpio::set_high(); }
+    void toggle() { PinGpio::toggle(); }
+
+private:
+    PinGpio gpio_;
+};
+
+
+// === multi-color led (RGB) ===
+template <gpio_num_t RedPin, gpio_num_t GreenPin, gpio_num_t BluePin,
+          Led::Configuration Config = Led::Configuration::CommonCathode>
+class MultiColorLed : public LedBase<MultiColorLed<RedPin, GreenPin, BluePin, Config>> {
+    static_assert(RedPin < 32 && GreenPin < 32 && BluePin < 32,
+                  "RGB pins must share GPIO bank 0 for single-write color changes");
+
+    static constexpr uint32_t red_mask = 1UL << RedPin;
+    static constexpr uint32_t green_mask = 1UL << GreenPin;
+    static constexpr uint32_t blue_mask = 1UL << BluePin;
+    static constexpr uint32_t all_mask = red_mask | green_mask | blue_mask;
+    static constexpr bool active_high = Config == Led::Configuration::CommonCathode;
+
+public:
+    static constexpr Led::Configuration configuration = Config;
+
+    MultiColorLed() {
+        gpio_config_t cfg = {};
+        cfg.pin_bit_mask = all_mask;
+        cfg.mode = GPIO_MODE_OUTPUT;
+        cfg.pull_up_en = GPIO_PULLUP_DISABLE;
+        cfg.pull_down_en = GPIO_PULLDOWN_DISABLE;
+        cfg.intr_type = GPIO_INTR_DISABLE;
+        gpio_config(&cfg);
+    }
+
+    void on()  { write(all_mask); }
+    void off() { write(0); }
+
+    void toggle() {
+        uint32_t high = REG_READ(GPIO_OUT_REG) & all_mask;
+        REG_WRITE(GPIO_OUT_W1TS_REG, all_mask & ~high);
+        REG_WRITE(GPIO_OUT_W1TC_REG, high);
+    }
+
+    void set_color(bool red, bool green, bool blue) {
+        write((red ? red_mask : 0) | (green ? green_mask : 0) | (blue ? blue_mask : 0));
+    }
+
+    // Colors known at compile time fold down to two constant stores
+    template <bool Red, bool Green, bool Blue>
+    void set_color() {
+        write((Red ? red_mask : 0) | (Green ? green_mask : 0) | (Blue ? blue_mask : 0));
+    }
+
+private:
+    // Set before clear, as GpioPort::write() does, so a color change never goes dark
+    static void write(uint32_t lit) {
+        uint32_t high = active_high ? lit : all_mask & ~lit;
+        REG_WRITE(GPIO_OUT_W1TS_REG, high);
+        REG_WRITE(GPIO_OUT_W1TC_REG, all_mask & ~high);
+    }
+};
+
+
+// === runtime adapter ===
+// Exposes a compile-time LED through the virtual driver::Led interface, with the
+// wrapped LED's polarity as the base class configuration
+template <typename StaticLed>
+class LedAdapter : public Led {
+public:
+    LedAdapter() : Led(StaticLed::configuration) {}
+
+    void on() override     { led_.on(); }
+    void off() override    { led_.off(); }
+    void toggle() override { led_.toggle(); }
+
+    StaticLed& get() { return led_; }
+
+private:
+    StaticLed led_;
+};
+
+} // namespace driver::fixed
@@ -0,0 +1,91 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Hot-path tracing with the CPU cycle counter.
+//
+//     void driver::Foo::bar() {
+//         TRACE_SCOPE("foo.bar");
+//         ...
+//     }
+//
+// Each TRACE_SCOPE owns a static probe that records how many cycles the enclosing
+// scope took into a log2 histogram. util::trace::dump() prints count, p50, p99 and
+// max for every probe that has fired. Build with -DTRACE_PROBES=1 to enable; without
+// it the macro expands to nothing, so probes can stay in production code.
+
+#ifndef TRACE_PROBES
+#define TRACE_PROBES 0
+#endif
+
+namespace util::trace {
+
+// Timing histogram for one probe site, kept in static storage
+class Probe {
+public:
+    static constexpr int BUCKETS = 33;   // bucket b holds durations in [2^(b-1), 2^b) cycles
+
+    explicit Probe(const char* name);
+
+    void record(uint32_t cycles);
+
+    const char* name() const { return name_; }
+    uint32_t count() const { return count_; }
+    uint32_t max() const { return max_; }
+
+    // Upper bound (in cycles) of the bucket holding the given percentile (0-100)
+    uint32_t percentile(uint32_t pct) const;
+
+    // Next probe in the registry, nullptr at the end
+    Probe* next() const { return next_; }
+
+    void reset();
+
+private:
+    const char* name_;
+    uint32_t count_ = 0;
+    uint32_t max_ = 0;
+    uint32_t buckets_[BUCKETS] = {};
+    Probe* next_ = nullptr;
+};
+
+// Times its own lifetime into a probe
+class Scope {
+public:
+    explicit Scope(Probe& probe);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    Probe& probe_;
+    uint32_t start_;
+};
+
+// Read the CPU cycle counter
+uint32_t cycles();
+
+// First registered probe (probes register themselves on first use)
+Probe* first_probe();
+
+// Print a table of all probes to the console
+void dump();
+
+// Clear every probe's histogram
+void reset_all();
+
+// Dump from a background task every period_ms
+bool start_dump_task(uint32_t period_ms = 10000);
+
+} // namespace util::trace
+
+#if TRACE_PROBES
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name)                                                           \
+    static util::trace::Probe TRACE_CONCAT(trace_probe_, __LINE__){name};           \
+    util::trace::Scope TRACE_CONCAT(trace_scope_, __LINE__){TRACE_CONCAT(trace_probe_, __LINE__)}
+#else
+#define TRACE_SCOPE(name) static_cast<void>(0)
+#endif
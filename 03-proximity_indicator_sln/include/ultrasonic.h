@@ -1,6 +1,10 @@
 #pragma once
 #include "led.h"  // For Gpio class
 #include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <atomic>
 #include <cstdint>
 
 namespace driver {
@@ -11,14 +15,26 @@ public:
         Success,        // Measurement completed successfully
         Timeout,        // No echo received within timeout period
         OutOfRange,     // Object too close or too far
+        Pending,        // Asynchronous measurement still in flight
         Error           // General error occurred
     };
 
+    // How the echo pulse is timed
+    enum class EchoMode {
+        Polling,        // Busy-wait on the echo pin (keeps the CPU spinning)
+        Interrupt       // Timestamp echo edges in a GPIO ISR, caller sleeps until done
+    };
+
     UltrasonicSensor(gpio_num_t trigger_pin, 
                      gpio_num_t echo_pin, 
-                     uint32_t timeout_us = 30000);
+                     uint32_t timeout_us = 30000,
+                     EchoMode mode = EchoMode::Polling);
+
+    ~UltrasonicSensor();
 
-    ~UltrasonicSensor() = default;
+    // The echo ISR keeps a pointer to the sensor, so it must not be copied
+    UltrasonicSensor(const UltrasonicSensor&) = delete;
+    UltrasonicSensor& operator=(const UltrasonicSensor&) = delete;
 
     // Perform a single distance measurement in cm
     Status measure_distance(float& distance);
@@ -26,7 +42,8 @@ public:
     // Perform multiple measurements and return the average in centimeters
     Status measure_distance_avg(float& distance, uint8_t samples = 3);
 
-    // Check if an object is within a specified range in centimeters
+    // Check if an object is within a specified range in centimeters.
+    // Gives up as soon as an echo from inside the threshold is no longer possible.
     bool is_object_in_range(float threshold_distance);
 
     // Set the measurement timeout
@@ -35,20 +52,89 @@ public:
     // Get the current timeout setting
     uint32_t get_timeout() const;
 
+    // Only look as far as max_range_cm: the timeout becomes the echo round trip for
+    // that range, so with nothing in range a measurement returns Timeout after a few
+    // milliseconds instead of the full 30 ms
+    void set_max_range(float max_range_cm);
+
+    // Farthest object the current timeout can see, in cm
+    float get_max_range() const;
+
+    // Timeout that covers an echo from range_cm away (trigger to falling edge)
+    static uint32_t range_to_timeout_us(float range_cm);
+
+    // Get the echo timing mode actually in use
+    // (Interrupt falls back to Polling if the ISR could not be installed)
+    EchoMode get_echo_mode() const;
+
+    // === Asynchronous measurement (Interrupt mode only) ===
+    // Fire the trigger and return immediately. Returns Error in Polling mode or if a
+    // measurement is already in flight. If notify_task is given, it receives a task
+    // notification (see ulTaskNotifyTake) when the echo completes.
+    Status start_measurement(TaskHandle_t notify_task = nullptr);
+
+    // Non-blocking: Pending while the echo is in flight, otherwise the final status
+    // (and distance in cm on Success). Reports Timeout once timeout_us has passed.
+    Status poll_measurement(float& distance);
+
+    // Sleep until the started measurement completes or times out
+    Status wait_measurement(float& distance);
+
+    // Record an edge on the echo pin. Called from the GPIO ISR in Interrupt mode;
+    // a fake GPIO/timer layer can call it directly to inject edges on a host.
+    void on_echo_edge(bool level, int64_t timestamp_us);
+
+    // Convert pulse duration to distance in cm
+    static float pulse_to_distance(uint32_t pulse_duration_us);
+
 
 private:
     Gpio trigger_gpio_;     // GPIO object for trigger signal
     Gpio echo_gpio_;        // GPIO object for echo signal
     uint32_t timeout_us_;   // Timeout for echo reception in microseconds
+    EchoMode mode_;         // Polling or interrupt-driven echo timing
+
+    // Interrupt mode state, shared with the echo ISR
+    SemaphoreHandle_t echo_done_ = nullptr;         // Given by the ISR on the falling edge
+    esp_timer_handle_t deadline_timer_ = nullptr;   // Gives echo_done_ when the timeout expires
+    TaskHandle_t notify_task_ = nullptr;            // Optional task to notify on completion
+    std::atomic<bool> echo_armed_{false};           // ISR accepts edges while set
+    std::atomic<bool> echo_complete_{false};        // Set by the ISR once both edges are seen
+    volatile int64_t echo_rise_us_ = -1;            // Timestamp of the rising edge
+    volatile int64_t echo_fall_us_ = -1;            // Timestamp of the falling edge
+    bool measurement_active_ = false;               // start_measurement() not yet collected
+    uint32_t active_timeout_us_ = 0;                // Timeout of the measurement in flight
+    int64_t trigger_time_us_ = 0;                   // When the trigger pulse finished
+
+    // Single measurement that gives up after timeout_us
+    Status measure_within(float& distance, uint32_t timeout_us);
+
+    // start_measurement() with an explicit timeout
+    Status start_within(uint32_t timeout_us, TaskHandle_t notify_task);
+
+    // Wait for the module to release the echo line after an aborted measurement
+    Status wait_for_echo_idle();
 
     // Send trigger pulse to start measurement
     void send_trigger_pulse();
 
-    // Wait for echo signal and measure duration
-    Status measure_echo_pulse(uint32_t& pulse_duration_us);
+    // Busy-wait for echo signal and measure duration (Polling mode)
+    Status measure_echo_pulse(uint32_t& pulse_duration_us, uint32_t timeout_us);
 
-    // Convert pulse duration to distance in cm
-    float pulse_to_distance(uint32_t pulse_duration_us);
+    // Reset the interrupt state before a new trigger
+    void arm_echo_capture();
+
+    // Collect the result of an asynchronous measurement and clear its state
+    Status finish_measurement(float& distance);
+
+    // Range-check a measured pulse
+    Status check_pulse(uint32_t pulse_duration_us, uint32_t timeout_us) const;
+
+    // GPIO ISR trampoline, arg is the owning sensor
+    static void echo_isr_handler(void* arg);
+
+    // esp_timer callback for the measurement deadline, arg is the owning sensor
+    static void deadline_handler(void* arg);
 };
 
 } // namespace driver
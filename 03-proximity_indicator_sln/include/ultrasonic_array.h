@@ -0,0 +1,79 @@
+#pragma once
+#include "ultrasonic.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace driver {
+
+// Several ultrasonic sensors measured as one unit. Sensors that cannot hear each
+// other are fired at the same time; sensors that interfere are split into
+// separate firing groups according to a crosstalk matrix.
+class UltrasonicArray {
+public:
+    using Status = UltrasonicSensor::Status;
+
+    // Largest supported array (crosstalk rows are 32-bit masks)
+    static constexpr size_t MAX_SENSORS = 32;
+
+    struct SensorPins {
+        gpio_num_t trigger_pin;
+        gpio_num_t echo_pin;
+    };
+
+    // Result of one sweep over every sensor in the array. Fixed capacity, so
+    // sweeping into it and copying it never touch the heap.
+    struct Snapshot {
+        uint32_t sweep_id = 0;                          // Increments once per sweep
+        int64_t timestamp_us = 0;                       // When the sweep finished
+        size_t count = 0;                               // Sensors in use, from index 0
+        std::array<float, MAX_SENSORS> distance_cm{};   // Per-sensor distance, valid where status is Success
+        std::array<Status, MAX_SENSORS> status{};       // Per-sensor measurement status
+    };
+
+    // crosstalk[i] has bit j set if sensor j can pick up sensor i's ping.
+    // The matrix is treated as symmetric; missing rows mean "no crosstalk".
+    UltrasonicArray(const std::vector<SensorPins>& pins,
+                    const std::vector<uint32_t>& crosstalk,
+                    uint32_t timeout_us = 30000);
+
+    ~UltrasonicArray();
+
+    UltrasonicArray(const UltrasonicArray&) = delete;
+    UltrasonicArray& operator=(const UltrasonicArray&) = delete;
+
+    // Measure every sensor once, group by group, and publish the result.
+    // Returns Success if at least one sensor produced a distance, Error otherwise.
+    Status sweep(Snapshot& snapshot);
+
+    // Copy of the most recently published sweep (safe to call from any task)
+    Snapshot latest_snapshot() const;
+
+    // Number of sensors in the array
+    size_t size() const;
+
+    // Number of firing groups per sweep (1 means every sensor fires at once)
+    size_t group_count() const;
+
+    // Access an individual sensor, e.g. to change its timeout
+    UltrasonicSensor& sensor(size_t index);
+
+private:
+    std::vector<std::unique_ptr<UltrasonicSensor>> sensors_;
+    std::vector<uint32_t> groups_;          // Bitmask of sensors fired together
+    uint32_t sweep_count_ = 0;
+
+    Snapshot latest_;                       // Last published sweep
+    SemaphoreHandle_t snapshot_mutex_;      // Guards latest_
+
+    // Split the sensors into groups with no crosstalk inside a group
+    void build_groups(const std::vector<uint32_t>& crosstalk);
+
+    // Fire one group together and collect its results into snapshot
+    void measure_group(uint32_t group, Snapshot& snapshot);
+};
+
+} // namespace driver
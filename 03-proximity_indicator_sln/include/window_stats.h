@@ -0,0 +1,208 @@
+#pragma once
+#include "ring_buffer.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+// Statistics over a sliding window of the most recent samples, updated as each
+// sample arrives instead of recomputed from scratch:
+//   - mean and variance: O(1) sliding update
+//   - min and max: O(1) amortized, monotonic queues
+//   - median: O(log B) Fenwick tree over B value bins
+// Everything lives inside the object; nothing is allocated after construction.
+//
+// The median is quantized to MEDIAN_BIN_WIDTH and clamped to
+// [0, MEDIAN_BIN_COUNT * MEDIAN_BIN_WIDTH), which suits ultrasonic distances in cm.
+template <size_t N>
+class WindowStats {
+public:
+    static constexpr size_t MEDIAN_BIN_COUNT = 1024;
+    static constexpr float MEDIAN_BIN_WIDTH = 0.5f;
+
+    // window is clamped to 1..N
+    explicit WindowStats(size_t window = N)
+        : window_(std::min(std::max<size_t>(window, 1), N)) {}
+
+    // Add a sample, evicting the oldest one once the window is full
+    void push(float value) {
+        if (samples_.size() >= window_) {
+            float oldest = samples_[0];
+            samples_.pop();
+            remove_moments(oldest);
+            median_update(bin_of(oldest), -1);
+        }
+
+        samples_.push(value);
+        add_moments(value);
+        median_update(bin_of(value), +1);
+        push_extremes(value);
+        ++sequence_;
+
+        // Rebuild the running sums now and then so float rounding cannot drift
+        if ((sequence_ % RECOMPUTE_INTERVAL) == 0) {
+            recompute_moments();
+        }
+    }
+
+    size_t size() const { return samples_.size(); }
+    size_t window() const { return window_; }
+    bool empty() const { return samples_.empty(); }
+
+    // Most recent sample; only valid when not empty
+    float latest() const { return samples_.back(); }
+
+    float mean() const { return mean_; }
+
+    // Population variance of the window
+    float variance() const {
+        size_t n = samples_.size();
+        return n > 1 ? std::max(m2_ / n, 0.0f) : 0.0f;
+    }
+
+    float stddev() const { return std::sqrt(variance()); }
+
+    float min() const { return min_queue_.front().value; }
+    float max() const { return max_queue_.front().value; }
+
+    float median() const {
+        size_t n = samples_.size();
+        if (n == 0) {
+            return 0.0f;
+        }
+        float lower = bin_center(median_kth((n + 1) / 2));
+        float upper = bin_center(median_kth(n / 2 + 1));
+        return (n % 2) ? lower : (lower + upper) / 2.0f;
+    }
+
+    // Raw samples, oldest first
+    const RingBuffer<float, N>& samples() const { return samples_; }
+
+private:
+    static constexpr uint32_t RECOMPUTE_INTERVAL = 4096;
+
+    // === monotonic queue for sliding min/max ===
+    struct Entry {
+        uint32_t sequence;
+        float value;
+    };
+
+    template <typename Compare>
+    class MonotonicQueue {
+    public:
+        // Expire entries that slid out of the window, drop those that can never
+        // be the extreme again, then append. Expiring first leaves at most
+        // window - 1 <= N - 1 entries, so the append never overwrites the front.
+        void push(uint32_t sequence, float value, size_t window) {
+            while (count_ > 0 && sequence - entries_[head_].sequence >= window) {
+                head_ = (head_ + 1) % N;
+                --count_;
+            }
+            while (count_ > 0 && !Compare()(back().value, value)) {
+                --count_;
+            }
+            entries_[(head_ + count_) % N] = Entry{sequence, value};
+            ++count_;
+        }
+
+        const Entry& front() const { return entries_[head_]; }
+
+    private:
+        const Entry& back() const { return entries_[(head_ + count_ - 1) % N]; }
+
+        std::array<Entry, N> entries_{};
+        size_t head_ = 0;
+        size_t count_ = 0;
+    };
+
+    struct Less    { bool operator()(float a, float b) const { return a < b; } };
+    struct Greater { bool operator()(float a, float b) const { return a > b; } };
+
+    RingBuffer<float, N> samples_;
+    size_t window_;
+    uint32_t sequence_ = 0;
+
+    // Running mean and sum of squared deviations (Welford, sliding form)
+    float mean_ = 0.0f;
+    float m2_ = 0.0f;
+
+    MonotonicQueue<Less> min_queue_;
+    MonotonicQueue<Greater> max_queue_;
+
+    // Fenwick tree of sample counts per median bin (1-based)
+    std::array<uint16_t, MEDIAN_BIN_COUNT + 1> median_tree_{};
+
+    void add_moments(float value) {
+        size_t n = samples_.size();
+        float delta = value - mean_;
+        mean_ += delta / n;
+        m2_ += delta * (value - mean_);
+    }
+
+    void remove_moments(float value) {
+        size_t n = samples_.size();   // count after the removal
+        if (n == 0) {
+            mean_ = 0.0f;
+            m2_ = 0.0f;
+            return;
+        }
+        float delta = value - mean_;
+        mean_ -= delta / n;
+        m2_ -= delta * (value - mean_);
+    }
+
+    void recompute_moments() {
+        size_t n = samples_.size();
+        float sum = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            sum += samples_[i];
+        }
+        mean_ = sum / n;
+
+        m2_ = 0.0f;
+        for (size_t i = 0; i < n; ++i) {
+            float d = samples_[i] - mean_;
+            m2_ += d * d;
+        }
+    }
+
+    void push_extremes(float value) {
+        min_queue_.push(sequence_, value, window_);
+        max_queue_.push(sequence_, value, window_);
+    }
+
+    static size_t bin_of(float value) {
+        if (!(value > 0.0f)) {
+            return 0;
+        }
+        size_t bin = static_cast<size_t>(value / MEDIAN_BIN_WIDTH);
+        return std::min(bin, MEDIAN_BIN_COUNT - 1);
+    }
+
+    static float bin_center(size_t bin) {
+        return (bin + 0.5f) * MEDIAN_BIN_WIDTH;
+    }
+
+    void median_update(size_t bin, int delta) {
+        for (size_t i = bin + 1; i <= MEDIAN_BIN_COUNT; i += i & (~i + 1)) {
+            median_tree_[i] = static_cast<uint16_t>(median_tree_[i] + delta);
+        }
+    }
+
+    // Bin holding the k-th smallest sample (k is 1-based)
+    size_t median_kth(size_t k) const {
+        size_t pos = 0;
+        for (size_t step = MEDIAN_BIN_COUNT; step > 0; step >>= 1) {
+            if (pos + step <= MEDIAN_BIN_COUNT && median_tree_[pos + step] < k) {
+                pos += step;
+                k -= median_tree_[pos];
+            }
+        }
+        return pos;   // 0-based bin index
+    }
+};
+
+} // namespace util
@@ -0,0 +1,241 @@
+#include "bench.h"
+#include "led.h"
+#include "static_led.h"
+#include "ultrasonic.h"
+#include "ring_buffer.h"
+#include "window_stats.h"
+#include "range_tracker.h"
+#include "deferred_log.h"
+#include "proximity_controller.h"
+#include "esp_rom_sys.h"
+#include <cstdio>
+#include <optional>
+
+static bench::AllocationCounter allocation_counter = nullptr;
+
+void bench::set_allocation_counter(AllocationCounter counter) {
+    allocation_counter = counter;
+}
+
+int64_t bench::allocations() {
+    return allocation_counter != nullptr ? static_cast<int64_t>(allocation_counter()) : -1;
+}
+
+// Cycles an empty batch of the same length takes
+static uint32_t loop_overhead(uint32_t iterations) {
+    uint32_t best = UINT32_MAX;
+    for (uint32_t r = 0; r < bench::REPEATS; ++r) {
+        uint32_t start = util::trace::cycles();
+        for (uint32_t i = 0; i < iterations; ++i) {
+            bench::keep(i);
+        }
+        uint32_t elapsed = util::trace::cycles() - start;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    return best;
+}
+
+bench::Result bench::make_result(const char* name, uint32_t iterations, uint32_t best_cycles,
+                                 int64_t allocations, uint32_t batches) {
+    uint32_t overhead = loop_overhead(iterations);
+    uint32_t net = best_cycles > overhead ? best_cycles - overhead : 0;
+
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.cycles_per_op = static_cast<float>(net) / iterations;
+    result.ns_per_op = result.cycles_per_op * 1000.0f / esp_rom_get_cpu_ticks_per_us();
+    result.allocs_per_op = allocations < 0 ? -1.0f
+                                           : static_cast<float>(allocations) / (iterations * batches);
+    return result;
+}
+
+void bench::print_header() {
+    printf("name,iterations,cycles_per_op,ns_per_op,allocs_per_op\n");
+}
+
+void bench::print(const Result& result) {
+    if (result.allocs_per_op < 0.0f) {
+        printf("%s,%u,%.1f,%.1f,\n", result.name, static_cast<unsigned>(result.iterations),
+               result.cycles_per_op, result.ns_per_op);
+    } else {
+        printf("%s,%u,%.1f,%.1f,%.3f\n", result.name, static_cast<unsigned>(result.iterations),
+               result.cycles_per_op, result.ns_per_op, result.allocs_per_op);
+    }
+}
+
+// One WindowStats::push benchmark per window length, all in a 256-sample buffer
+template <size_t Window>
+static bench::Result window_push(const char* name) {
+    util::WindowStats<256> stats(Window);
+    uint32_t n = 0;
+    return bench::measure(name, 1000, [&] {
+        stats.push(static_cast<float>(n++ & 127));
+        bench::keep(stats);
+    });
+}
+
+void bench::run_all() {
+    print_header();
+
+    // === GPIO ===
+    // Same pins as app_main(): RGB LED on 27/26/25 (common anode), sensor on 16/17
+    {
+        driver::Gpio gpio(GPIO_NUM_27);
+        print(measure("gpio.set_high", 1000, [&] { gpio.set_high(); }));
+        print(measure("gpio.toggle", 1000, [&] { gpio.toggle(); }));
+
+        driver::GpioPort port({GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25});
+        uint64_t red = driver::GpioPort::pin_mask(GPIO_NUM_27);
+        uint64_t blue = driver::GpioPort::pin_mask(GPIO_NUM_25);
+        bool flip = false;
+        print(measure("gpio_port.write", 1000, [&] {
+            flip = !flip;
+            port.write(flip ? red : blue, flip ? blue : red);
+        }));
+
+        using FixedRed = driver::fixed::Gpio<GPIO_NUM_27>;
+        FixedRed fixed_gpio;
+        print(measure("fixed_gpio.set_high", 1000, [&] { FixedRed::set_high(); }));
+        print(measure("fixed_gpio.toggle", 1000, [&] { FixedRed::toggle(); }));
+    }
+
+    // === LEDs ===
+    {
+        driver::MultiColorLed led(GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25,
+                                  driver::Led::Configuration::CommonAnode);
+        uint32_t n = 0;
+        print(measure("led.set_color", 1000, [&] {
+            ++n;
+            led.set_color(n & 1, n & 2, n & 4);
+        }));
+
+        // The path set_color replaced: one gpio_set_level per color pin
+        driver::Gpio red(GPIO_NUM_27), green(GPIO_NUM_26), blue(GPIO_NUM_25);
+        print(measure("led.set_color_per_pin", 1000, [&] {
+            ++n;
+            (n & 1) ? red.set_low() : red.set_high();
+            (n & 2) ? green.set_low() : green.set_high();
+            (n & 4) ? blue.set_low() : blue.set_high();
+        }));
+
+        driver::Led& base = led;
+        print(measure("led.on_off_virtual", 1000, [&] {
+            (++n & 1) ? base.on() : base.off();
+        }));
+
+        using FixedLed = driver::fixed::MultiColorLed<GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25,
+                                                      driver::Led::Configuration::CommonAnode>;
+        FixedLed fixed_led;
+        print(measure("fixed_led.set_color", 1000, [&] {
+            ++n;
+            fixed_led.set_color(n & 1, n & 2, n & 4);
+        }));
+        print(measure("fixed_led.on_off", 1000, [&] {
+            (++n & 1) ? fixed_led.on() : fixed_led.off();
+        }));
+
+        driver::fixed::LedAdapter<FixedLed> adapter;
+        driver::Led& adapted = adapter;
+        print(measure("fixed_led.on_off_adapter", 1000, [&] {
+            (++n & 1) ? adapted.on() : adapted.off();
+        }));
+    }
+
+    // === Ultrasonic sensor ===
+    driver::MultiColorLed led(GPIO_NUM_27, GPIO_NUM_26, GPIO_NUM_25,
+                              driver::Led::Configuration::CommonAnode);
+    driver::UltrasonicSensor sensor(GPIO_NUM_16, GPIO_NUM_17, 30000,
+                                    driver::UltrasonicSensor::EchoMode::Interrupt);
+    {
+        uint32_t pulse = 0;
+        print(measure("ultrasonic.pulse_to_distance", 1000, [&] {
+            bench::keep(driver::UltrasonicSensor::pulse_to_distance(150 + (pulse++ & 4095)));
+        }));
+
+        // Dominated by echo time and the pause between samples; without a sensor
+        // wired this times the timeout path
+        float distance = 0.0f;
+        print(measure("ultrasonic.measure_distance_avg", 2, [&] {
+            sensor.measure_distance_avg(distance);
+            bench::keep(distance);
+        }, 3));
+    }
+
+    // === History and filters ===
+    {
+        util::WindowStats<app::ProximityLightingController::MAX_HISTORY> history(8);
+        uint32_t n = 0;
+        print(measure("history.push", 1000, [&] {
+            history.push(static_cast<float>(n++ & 63));
+            bench::keep(history);
+        }));
+        print(measure("history.median", 1000, [&] { bench::keep(history.median()); }));
+        print(measure("history.stddev", 1000, [&] { bench::keep(history.stddev()); }));
+
+        print(window_push<8>("window_stats.push_w8"));
+        print(window_push<32>("window_stats.push_w32"));
+        print(window_push<64>("window_stats.push_w64"));
+        print(window_push<256>("window_stats.push_w256"));
+
+        util::RingBuffer<float, 64> ring;
+        print(measure("ring_buffer.push_pop", 1000, [&] {
+            float value = static_cast<float>(n++);
+            ring.push(value);
+            ring.pop(value);
+            bench::keep(value);
+        }));
+
+        util::RangeTracker tracker;
+        float range = 150.0f;
+        print(measure("tracker.update", 1000, [&] {
+            range = range > 5.0f ? range - 0.5f : 150.0f;
+            tracker.update(range, 0.06f);
+            bench::keep(tracker);
+        }));
+    }
+
+    // === Diagnostics ===
+    {
+        // A batch fills the log exactly, so every call takes the queueing path;
+        // many batches make up for the short ones. log.deferred_no_clock stubs the
+        // timestamp to separate the queueing from the esp_timer read, which on the
+        // host simulator takes a lock and dominates.
+        static_assert(LOG_BATCH <= util::DeferredLog::CAPACITY, "log batch would drop records");
+        float distance = 42.0f;
+        std::optional<util::DeferredLog> log;
+        for (bool clock : {true, false}) {
+            auto reset = [&] { clock ? log.emplace() : log.emplace([]() -> int64_t { return 0; }); };
+            reset();
+            print(measure_with_reset(clock ? "log.deferred" : "log.deferred_no_clock", LOG_BATCH, [&] {
+                DEFERRED_LOG(*log, "Distance:%.1f cm | median %.1f | mean %.1f +/- %.2f | closing %.1f cm/s | next %d ms | %s",
+                             distance, distance, distance, 0.5f, 1.0f, 60, "Safe");
+            }, reset, LOG_REPEATS));
+        }
+
+        char line[160];
+        print(measure("log.snprintf", LOG_BATCH, [&] {
+            snprintf(line, sizeof(line),
+                     "Distance:%.1f cm | median %.1f | mean %.1f +/- %.2f | closing %.1f cm/s | next %d ms | %s",
+                     distance, distance, distance, 0.5f, 1.0f, 60, "Safe");
+            bench::keep(line);
+        }, LOG_REPEATS));
+    }
+
+    // === Controller ===
+    {
+        app::ProximityLightingController::Config config(20.0f, 10.0f, 50.0f, 200, 8);
+        app::ProximityLightingController controller(led, sensor, config);
+
+        // Once its log buffer is full the controller drops diagnostics, so this
+        // times the drop path of the logging after the first 32 calls
+        float distance = 150.0f;
+        print(measure("controller.update", 1000, [&] {
+            distance = distance > 5.0f ? distance - 0.25f : 150.0f;
+            controller.update(distance);
+        }));
+        print(measure("controller.classify", 1000, [&] { bench::keep(controller.classify()); }));
+    }
+}
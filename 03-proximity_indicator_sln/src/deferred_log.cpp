@@ -0,0 +1,84 @@
+#include "deferred_log.h"
+#include "esp_timer.h"
+#include <cstdio>
+#include <cstring>
+
+// Longest line drain() will print; longer output is truncated
+static constexpr size_t LINE_LENGTH = 192;
+
+int64_t util::DeferredLog::now_us() {
+    return esp_timer_get_time();
+}
+
+size_t util::DeferredLog::drain(size_t max_records) {
+    size_t printed = 0;
+    Record record;
+    while (printed < max_records && records_.pop(record)) {
+        print(record);
+        ++printed;
+    }
+    return printed;
+}
+
+bool util::DeferredLog::start_drain_task(UBaseType_t priority, uint32_t period_ms) {
+    drain_period_ms_ = period_ms;
+    return xTaskCreate(drain_task, "log_drain", 3072, this, priority, nullptr) == pdPASS;
+}
+
+void util::DeferredLog::drain_task(void* arg) {
+    auto* log = static_cast<DeferredLog*>(arg);
+    uint32_t reported_drops = 0;
+
+    while (true) {
+        log->drain();
+
+        uint32_t drops = log->dropped();
+        if (drops != reported_drops) {
+            printf("[log] %u records dropped\n", static_cast<unsigned>(drops - reported_drops));
+            reported_drops = drops;
+        }
+
+        vTaskDelay(pdMS_TO_TICKS(log->drain_period_ms_));
+    }
+}
+
+void util::DeferredLog::print(const Record& record) {
+    char line[LINE_LENGTH];
+    size_t length = snprintf(line, sizeof(line), "[%lld] ",
+                             static_cast<long long>(record.timestamp_us / 1000));
+    size_t arg = 0;
+
+    // Walk the format, handing each conversion to snprintf with its stored argument
+    for (const char* p = record.format; *p != '\0' && length < sizeof(line) - 1; ) {
+        if (*p != '%' || p[1] == '%' || arg >= record.arg_count) {
+            line[length++] = *p;
+            p += (*p == '%' && p[1] == '%') ? 2 : 1;
+            continue;
+        }
+
+        // Copy one conversion spec, e.g. "%6.1f"
+        char spec[16];
+        size_t spec_length = 0;
+        do {
+            spec[spec_length++] = *p++;
+        } while (*p != '\0' && spec_length < sizeof(spec) - 1 && !strchr("diuxXfFeEgGcs", p[-1]));
+        spec[spec_length] = '\0';
+
+        const Arg& value = record.args[arg];
+        char* out = line + length;
+        size_t space = sizeof(line) - length;
+        int written = 0;
+        switch (record.types[arg]) {
+            case 'f': written = snprintf(out, space, spec, static_cast<double>(value.f)); break;
+            case 'i': written = snprintf(out, space, spec, static_cast<int>(value.i)); break;
+            case 'u': written = snprintf(out, space, spec, static_cast<unsigned>(value.u)); break;
+            case 's': written = snprintf(out, space, spec, value.s); break;
+        }
+        length += written > 0 ? static_cast<size_t>(written) : 0;
+        length = length < sizeof(line) - 1 ? length : sizeof(line) - 1;
+        ++arg;
+    }
+
+    line[length] = '\0';
+    puts(line);
+}
@@ -1,4 +1,7 @@
 #include "led.h"
+#include "trace.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -29,12 +32,66 @@ void driver::Gpio::toggle()   { gpio_set_level(pin_, !gpio_get_level(pin_)); }
 bool driver::Gpio::read() const { return gpio_get_level(pin_); }
 
 
+// ========================= GPIO PORT =========================
+
+driver::GpioPort::GpioPort(std::initializer_list<gpio_num_t> pins, gpio_mode_t mode)
+    : mask_(0)
+{
+    for (gpio_num_t pin : pins) {
+        if (pin >= 0 && pin < GPIO_NUM_MAX) {
+            mask_ |= pin_mask(pin);
+        }
+    }
+
+    gpio_config_t cfg = {};
+    cfg.pin_bit_mask = mask_;
+    cfg.mode = mode;
+    cfg.pull_up_en = GPIO_PULLUP_DISABLE;
+    cfg.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    cfg.intr_type = GPIO_INTR_DISABLE;
+    gpio_config(&cfg);
+}
+
+// Register stores for one direction, skipping a bank with nothing to change
+static void write_banks(uint32_t bank0_reg, uint32_t bank1_reg, uint64_t mask) {
+    if (static_cast<uint32_t>(mask)) {
+        REG_WRITE(bank0_reg, static_cast<uint32_t>(mask));
+    }
+    if (mask >> 32) {
+        REG_WRITE(bank1_reg, static_cast<uint32_t>(mask >> 32));
+    }
+}
+
+void driver::GpioPort::set(uint64_t mask) {
+    write_banks(GPIO_OUT_W1TS_REG, GPIO_OUT1_W1TS_REG, mask & mask_);
+}
+
+void driver::GpioPort::clear(uint64_t mask) {
+    write_banks(GPIO_OUT_W1TC_REG, GPIO_OUT1_W1TC_REG, mask & mask_);
+}
+
+void driver::GpioPort::write(uint64_t set_mask, uint64_t clear_mask) {
+    // Set before clear, and never clear a pin that is being set: a pin that
+    // stays high is not touched, and an RGB change never passes through dark
+    set(set_mask);
+    clear(clear_mask & ~set_mask);
+}
+
+void driver::GpioPort::toggle(uint64_t mask) {
+    uint64_t high = (static_cast<uint64_t>(REG_READ(GPIO_OUT1_REG)) << 32 | REG_READ(GPIO_OUT_REG)) & mask & mask_;
+    write(mask & mask_ & ~high, high);
+}
+
+uint64_t driver::GpioPort::read() const {
+    return (static_cast<uint64_t>(REG_READ(GPIO_IN1_REG)) << 32 | REG_READ(GPIO_IN_REG)) & mask_;
+}
+
+
 // ========================= SINGLE-COLOR LED =========================
 
 driver::SingleColorLed::SingleColorLed(gpio_num_t pin, Configuration config)
-    : gpio_(pin, GPIO_MODE_OUTPUT, GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE) {
-    config_ = config;
-}
+    : Led(config),
+      gpio_(pin, GPIO_MODE_OUTPUT, GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE) {}
 
 void driver::SingleColorLed::on() {
     if (config_ == Configuration::CommonCathode)
@@ -58,38 +115,33 @@ void driver::SingleColorLed::toggle() {
 // ========================= MULTI-COLOR LED =========================
 driver::MultiColorLed::MultiColorLed(gpio_num_t red_pin, gpio_num_t green_pin, gpio_num_t blue_pin,
                                       Configuration config)
-    : red_(red_pin, config),
-      green_(green_pin, config),
-      blue_(blue_pin, config) {
-    config_ = config;
-}
+    : ColorLed(config),
+      red_mask_(GpioPort::pin_mask(red_pin)),
+      green_mask_(GpioPort::pin_mask(green_pin)),
+      blue_mask_(GpioPort::pin_mask(blue_pin)),
+      port_({red_pin, green_pin, blue_pin}) {}
 
 void driver::MultiColorLed::on() {
-    red_.on();
-    green_.on();
-    blue_.on();
+    set_color(true, true, true);
 }
 
 void driver::MultiColorLed::off() {
-    red_.off();
-    green_.off();
-    blue_.off();
+    set_color(false, false, false);
 }
 
 void driver::MultiColorLed::set_color(bool red, bool green, bool blue) {
-    // Turn off all colors first
-    red_.off();
-    green_.off();
-    blue_.off();
-    
-    // Turn on requested colors
-    if (red)   red_.on();
-    if (green) green_.on();
-    if (blue)  blue_.on();
+    TRACE_SCOPE("led.set_color");
+
+    uint64_t lit = (red ? red_mask_ : 0) | (green ? green_mask_ : 0) | (blue ? blue_mask_ : 0);
+    uint64_t unlit = port_.mask() & ~lit;
+
+    // One write updates every channel, so there are no intermediate colors
+    if (config_ == Configuration::CommonCathode)
+        port_.write(lit, unlit);
+    else
+        port_.write(unlit, lit);
 }
 
 void driver::MultiColorLed::toggle() {
-    red_.toggle();
-    green_.toggle();
-    blue_.toggle();
+    port_.toggle(port_.mask());
 }
@@ -0,0 +1,96 @@
+#include "pwm_led.h"
+
+driver::PwmRgbLedBase::PwmRgbLedBase(gpio_num_t red_pin, gpio_num_t green_pin, gpio_num_t blue_pin,
+                                     Configuration config,
+                                     ledc_timer_t timer,
+                                     ledc_channel_t first_channel,
+                                     ledc_timer_bit_t resolution,
+                                     uint32_t frequency_hz,
+                                     const GammaTable& gamma)
+    : ColorLed(config),
+      gamma_(gamma),
+      channels_{first_channel,
+                static_cast<ledc_channel_t>(first_channel + 1),
+                static_cast<ledc_channel_t>(first_channel + 2)},
+      color_{255, 255, 255},
+      lit_(false)
+{
+    ledc_timer_config_t timer_cfg = {};
+    timer_cfg.speed_mode = SPEED_MODE;
+    timer_cfg.duty_resolution = resolution;
+    timer_cfg.timer_num = timer;
+    timer_cfg.freq_hz = frequency_hz;
+    timer_cfg.clk_cfg = LEDC_AUTO_CLK;
+    ledc_timer_config(&timer_cfg);
+
+    const std::array<gpio_num_t, CHANNEL_COUNT> pins = {red_pin, green_pin, blue_pin};
+    for (size_t i = 0; i < CHANNEL_COUNT; ++i) {
+        ledc_channel_config_t channel_cfg = {};
+        channel_cfg.gpio_num = pins[i];
+        channel_cfg.speed_mode = SPEED_MODE;
+        channel_cfg.channel = channels_[i];
+        channel_cfg.intr_type = LEDC_INTR_DISABLE;
+        channel_cfg.timer_sel = timer;
+        channel_cfg.duty = 0;
+        channel_cfg.hpoint = 0;
+        // common anode: the pin sinks current, so invert the output in hardware
+        channel_cfg.flags.output_invert = (config == Configuration::CommonAnode) ? 1 : 0;
+        ledc_channel_config(&channel_cfg);
+    }
+
+    // Shared by every LEDC user; fails harmlessly if already installed
+    ledc_fade_func_install(0);
+}
+
+void driver::PwmRgbLedBase::on() {
+    lit_ = true;
+    apply(color_, 0);
+}
+
+void driver::PwmRgbLedBase::off() {
+    lit_ = false;
+    apply({0, 0, 0}, 0);
+}
+
+void driver::PwmRgbLedBase::toggle() {
+    if (lit_)
+        off();
+    else
+        on();
+}
+
+void driver::PwmRgbLedBase::set_color(bool red, bool green, bool blue) {
+    fade_to_rgb(red ? 255 : 0, green ? 255 : 0, blue ? 255 : 0, color_fade_ms_);
+}
+
+void driver::PwmRgbLedBase::set_color_fade_ms(uint32_t fade_ms) {
+    color_fade_ms_ = fade_ms;
+}
+
+void driver::PwmRgbLedBase::set_rgb(uint8_t red, uint8_t green, uint8_t blue) {
+    color_ = {red, green, blue};
+    lit_ = true;
+    apply(color_, 0);
+}
+
+void driver::PwmRgbLedBase::fade_to_rgb(uint8_t red, uint8_t green, uint8_t blue, uint32_t duration_ms) {
+    color_ = {red, green, blue};
+    lit_ = true;
+    apply(color_, duration_ms);
+}
+
+void driver::PwmRgbLedBase::apply(const std::array<uint8_t, CHANNEL_COUNT>& rgb, uint32_t fade_ms) {
+    for (size_t i = 0; i < CHANNEL_COUNT; ++i) {
+        // Retarget from wherever a running fade has got to
+        ledc_fade_stop(SPEED_MODE, channels_[i]);
+
+        uint32_t duty = gamma_[rgb[i]];
+        if (fade_ms == 0) {
+            ledc_set_duty(SPEED_MODE, channels_[i], duty);
+            ledc_update_duty(SPEED_MODE, channels_[i]);
+        } else {
+            ledc_set_fade_with_time(SPEED_MODE, channels_[i], duty, fade_ms);
+            ledc_fade_start(SPEED_MODE, channels_[i], LEDC_FADE_NO_WAIT);
+        }
+    }
+}
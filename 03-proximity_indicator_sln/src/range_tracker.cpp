@@ -0,0 +1,70 @@
+#include "range_tracker.h"
+#include "trace.h"
+#include <limits>
+
+util::RangeTracker::RangeTracker(float alpha, float beta)
+    : alpha_(alpha), beta_(beta), range_cm_(0.0f), velocity_cm_s_(0.0f), samples_(0) {}
+
+void util::RangeTracker::update(float measured_cm, float dt_s) {
+    TRACE_SCOPE("tracker.update");
+
+    if (samples_ == 0 || dt_s <= 0.0f) {
+        // First sample (or no usable time step): start the track at the measurement
+        range_cm_ = measured_cm;
+        velocity_cm_s_ = 0.0f;
+        samples_ = 1;
+        return;
+    }
+
+    if (samples_ == 1) {
+        // Second sample: seed the velocity from the two-point difference
+        velocity_cm_s_ = (measured_cm - range_cm_) / dt_s;
+        range_cm_ = measured_cm;
+        samples_ = 2;
+        return;
+    }
+
+    // Predict forward, then correct by a fraction of the residual
+    float predicted = range_cm_ + velocity_cm_s_ * dt_s;
+    float residual = measured_cm - predicted;
+
+    range_cm_ = predicted + alpha_ * residual;
+    velocity_cm_s_ += (beta_ / dt_s) * residual;
+    ++samples_;
+}
+
+void util::RangeTracker::reset() {
+    range_cm_ = 0.0f;
+    velocity_cm_s_ = 0.0f;
+    samples_ = 0;
+}
+
+bool util::RangeTracker::is_tracking() const {
+    return samples_ >= 2;
+}
+
+float util::RangeTracker::range() const {
+    return range_cm_;
+}
+
+float util::RangeTracker::velocity() const {
+    return velocity_cm_s_;
+}
+
+float util::RangeTracker::predict(float dt_s) const {
+    return range_cm_ + velocity_cm_s_ * dt_s;
+}
+
+float util::RangeTracker::time_to_reach(float threshold_cm) const {
+    // Without a velocity there is no approach to predict (and no range after a reset)
+    if (!is_tracking()) {
+        return std::numeric_limits<float>::max();
+    }
+    if (range_cm_ <= threshold_cm) {
+        return 0.0f;
+    }
+    if (velocity_cm_s_ >= 0.0f) {
+        return std::numeric_limits<float>::max();
+    }
+    return (range_cm_ - threshold_cm) / -velocity_cm_s_;
+}
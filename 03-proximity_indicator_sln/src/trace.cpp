@@ -0,0 +1,109 @@
+#include "trace.h"
+#include "esp_cpu.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <cstdio>
+
+// Head of the intrusive list of registered probes
+static std::atomic<util::trace::Probe*> probe_list{nullptr};
+
+util::trace::Probe::Probe(const char* name)
+    : name_(name)
+{
+    // Lock-free push onto the registry so probes in any task can register
+    Probe* head = probe_list.load(std::memory_order_relaxed);
+    do {
+        next_ = head;
+    } while (!probe_list.compare_exchange_weak(head, this, std::memory_order_release,
+                                               std::memory_order_relaxed));
+}
+
+void util::trace::Probe::record(uint32_t cycles) {
+    // Statistics only: a rare lost update between tasks is acceptable
+    int bucket = cycles == 0 ? 0 : 32 - __builtin_clz(cycles);
+    buckets_[bucket]++;
+    count_++;
+    if (cycles > max_) {
+        max_ = cycles;
+    }
+}
+
+uint32_t util::trace::Probe::percentile(uint32_t pct) const {
+    if (count_ == 0) {
+        return 0;
+    }
+
+    uint64_t target = (static_cast<uint64_t>(count_) * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; ++b) {
+        seen += buckets_[b];
+        if (seen >= target) {
+            uint32_t upper = b == 0 ? 0 : (b >= 32 ? UINT32_MAX : (1UL << b) - 1);
+            return upper < max_ ? upper : max_;
+        }
+    }
+    return max_;
+}
+
+void util::trace::Probe::reset() {
+    count_ = 0;
+    max_ = 0;
+    for (uint32_t& bucket : buckets_) {
+        bucket = 0;
+    }
+}
+
+util::trace::Scope::Scope(Probe& probe)
+    : probe_(probe), start_(cycles()) {}
+
+util::trace::Scope::~Scope() {
+    probe_.record(cycles() - start_);
+}
+
+uint32_t util::trace::cycles() {
+    return esp_cpu_get_cycle_count();
+}
+
+util::trace::Probe* util::trace::first_probe() {
+    return probe_list.load(std::memory_order_acquire);
+}
+
+void util::trace::dump() {
+    uint32_t cycles_per_us = esp_rom_get_cpu_ticks_per_us();
+
+    printf("=== Trace (cycles, %u MHz) ===\n", static_cast<unsigned>(cycles_per_us));
+    printf("%-24s %10s %10s %10s %10s %10s\n", "probe", "count", "p50", "p99", "max", "max_us");
+    for (const Probe* p = first_probe(); p != nullptr; p = p->next()) {
+        if (p->count() == 0) {
+            continue;
+        }
+        printf("%-24s %10u %10u %10u %10u %10u\n", p->name(),
+               static_cast<unsigned>(p->count()),
+               static_cast<unsigned>(p->percentile(50)),
+               static_cast<unsigned>(p->percentile(99)),
+               static_cast<unsigned>(p->max()),
+               static_cast<unsigned>(p->max() / cycles_per_us));
+    }
+    printf("==============================\n");
+}
+
+void util::trace::reset_all() {
+    for (Probe* p = first_probe(); p != nullptr; p = p->next()) {
+        p->reset();
+    }
+}
+
+static void dump_task(void* arg) {
+    uint32_t period_ms = reinterpret_cast<uintptr_t>(arg);
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(period_ms));
+        util::trace::dump();
+    }
+}
+
+bool util::trace::start_dump_task(uint32_t period_ms) {
+    return xTaskCreate(dump_task, "trace_dump", 3072,
+                       reinterpret_cast<void*>(static_cast<uintptr_t>(period_ms)),
+                       1, nullptr) == pdPASS;
+}
@@ -1,6 +1,8 @@
 #include "ultrasonic.h"
 #include "driver/gpio.h"
 #include "esp_timer.h"
+#include "esp_attr.h"
+#include "trace.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include <algorithm>
@@ -13,26 +15,89 @@ static constexpr float SPEED_OF_SOUND_CM_PER_US = 0.0343f;  // cm/microseconds
 static constexpr uint32_t TRIGGER_PULSE_US = 10;        // Trigger pulse duration
 static constexpr uint32_t TRIGGER_SETTLE_US = 2;        // Time to settle before trigger
 static constexpr uint32_t MEASUREMENT_DELAY_MS = 60;    // Delay between measurements
+static constexpr uint32_t MIN_PULSE_US = 150;           // Shorter echoes are below the sensor's range
+static constexpr uint32_t ECHO_START_US = 500;          // Trigger to echo rise (~450 us burst on an HC-SR04)
+static constexpr uint32_t ECHO_IDLE_TIMEOUT_US = 40000; // Longest the module holds the echo high (~38 ms, no target)
 
 driver::UltrasonicSensor::UltrasonicSensor(gpio_num_t trigger_pin, 
                                             gpio_num_t echo_pin, 
-                                            uint32_t timeout_us)
+                                            uint32_t timeout_us,
+                                            EchoMode mode)
     : trigger_gpio_(trigger_pin, GPIO_MODE_OUTPUT, GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE),
       echo_gpio_(echo_pin, GPIO_MODE_INPUT, GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, GPIO_INTR_DISABLE),
-      timeout_us_(timeout_us)
+      timeout_us_(timeout_us),
+      mode_(EchoMode::Polling)
 {
     // Set trigger pin to low initially
     trigger_gpio_.set_low();
+
+    if (mode == EchoMode::Interrupt) {
+        echo_done_ = xSemaphoreCreateBinary();
+
+        // The ISR service is shared by every driver, so it may already be installed
+        esp_err_t err = gpio_install_isr_service(0);
+        if (echo_done_ == nullptr || (err != ESP_OK && err != ESP_ERR_INVALID_STATE) ||
+            gpio_isr_handler_add(echo_pin, echo_isr_handler, this) != ESP_OK) {
+            return;     // Stay in Polling mode, the echo pin raises no interrupts
+        }
+        // Edge interrupts only once a handler is there to take them
+        if (gpio_set_intr_type(echo_pin, GPIO_INTR_ANYEDGE) != ESP_OK) {
+            gpio_isr_handler_remove(echo_pin);
+            return;
+        }
+        mode_ = EchoMode::Interrupt;
+
+        // Wakes wait_measurement() right at the timeout instead of on the next tick
+        esp_timer_create_args_t args = {};
+        args.callback = &UltrasonicSensor::deadline_handler;
+        args.arg = this;
+        args.dispatch_method = ESP_TIMER_TASK;
+        args.name = "echo_deadline";
+        if (esp_timer_create(&args, &deadline_timer_) != ESP_OK) {
+            deadline_timer_ = nullptr;
+        }
+    }
+}
+
+driver::UltrasonicSensor::~UltrasonicSensor() {
+    if (mode_ == EchoMode::Interrupt) {
+        gpio_isr_handler_remove(echo_gpio_.pin());
+    }
+    if (deadline_timer_ != nullptr) {
+        esp_timer_stop(deadline_timer_);
+        esp_timer_delete(deadline_timer_);
+    }
+    if (echo_done_ != nullptr) {
+        vSemaphoreDelete(echo_done_);
+    }
 }
 
 driver::UltrasonicSensor::Status driver::UltrasonicSensor::measure_distance(float& distance) {
+    return measure_within(distance, timeout_us_);
+}
+
+driver::UltrasonicSensor::Status driver::UltrasonicSensor::measure_within(float& distance, uint32_t timeout_us) {
+    // Interrupt mode: fire the trigger and sleep until the ISR reports the echo
+    if (mode_ == EchoMode::Interrupt) {
+        Status status = start_within(timeout_us, nullptr);
+        if (status != Status::Success) {
+            return status;
+        }
+        return wait_measurement(distance);
+    }
+
     uint32_t pulse_duration_us;
+
+    Status status = wait_for_echo_idle();
+    if (status != Status::Success) {
+        return status;
+    }
     
     // Send trigger pulse
     send_trigger_pulse();
     
     // Measure echo pulse duration
-    Status status = measure_echo_pulse(pulse_duration_us);
+    status = measure_echo_pulse(pulse_duration_us, timeout_us);
     if (status != Status::Success) {
         return status;
     }
@@ -76,8 +141,11 @@ driver::UltrasonicSensor::Status driver::UltrasonicSensor::measure_distance_avg(
 }
 
 bool driver::UltrasonicSensor::is_object_in_range(float threshold_distance) {
+    // Stop listening once the echo is later than a round trip to the threshold
+    uint32_t timeout_us = std::min(timeout_us_, range_to_timeout_us(threshold_distance));
+
     float measured_distance;
-    Status status = measure_distance(measured_distance);
+    Status status = measure_within(measured_distance, timeout_us);
     
     if (status != Status::Success) {
         return false;
@@ -94,7 +162,110 @@ uint32_t driver::UltrasonicSensor::get_timeout() const {
     return timeout_us_;
 }
 
+void driver::UltrasonicSensor::set_max_range(float max_range_cm) {
+    timeout_us_ = range_to_timeout_us(max_range_cm);
+}
+
+float driver::UltrasonicSensor::get_max_range() const {
+    if (timeout_us_ <= ECHO_START_US) {
+        return 0.0f;
+    }
+    return pulse_to_distance(timeout_us_ - ECHO_START_US);
+}
+
+uint32_t driver::UltrasonicSensor::range_to_timeout_us(float range_cm) {
+    if (range_cm <= 0.0f) {
+        return ECHO_START_US;
+    }
+    // Round trip at the speed of sound, plus the delay before the echo starts
+    return ECHO_START_US + static_cast<uint32_t>(std::ceil(2.0f * range_cm / SPEED_OF_SOUND_CM_PER_US));
+}
+
+driver::UltrasonicSensor::EchoMode driver::UltrasonicSensor::get_echo_mode() const {
+    return mode_;
+}
+
+driver::UltrasonicSensor::Status driver::UltrasonicSensor::start_measurement(TaskHandle_t notify_task) {
+    return start_within(timeout_us_, notify_task);
+}
+
+driver::UltrasonicSensor::Status driver::UltrasonicSensor::start_within(uint32_t timeout_us, TaskHandle_t notify_task) {
+    // Only the ISR can finish a measurement without the caller watching the pin
+    if (mode_ != EchoMode::Interrupt || measurement_active_) {
+        return Status::Error;
+    }
+
+    Status status = wait_for_echo_idle();
+    if (status != Status::Success) {
+        return status;
+    }
+
+    notify_task_ = notify_task;
+    active_timeout_us_ = timeout_us;
+    arm_echo_capture();
+    measurement_active_ = true;
+
+    send_trigger_pulse();
+    trigger_time_us_ = esp_timer_get_time();
+    if (deadline_timer_ != nullptr) {
+        esp_timer_start_once(deadline_timer_, timeout_us);
+    }
+
+    return Status::Success;
+}
+
+driver::UltrasonicSensor::Status driver::UltrasonicSensor::poll_measurement(float& distance) {
+    if (!measurement_active_) {
+        return Status::Error;
+    }
+
+    if (!echo_complete_ && (esp_timer_get_time() - trigger_time_us_) <= active_timeout_us_) {
+        return Status::Pending;
+    }
+
+    return finish_measurement(distance);
+}
+
+driver::UltrasonicSensor::Status driver::UltrasonicSensor::wait_measurement(float& distance) {
+    TRACE_SCOPE("ultrasonic.echo_wait");
+
+    if (!measurement_active_) {
+        return Status::Error;
+    }
+
+    // Sleep until the ISR reports the echo or the deadline timer fires. The tick
+    // timeout is a backstop: whatever is left of the window, rounded up to whole
+    // ticks plus one so a partially elapsed tick never cuts it short. A wake-up
+    // left over from an earlier measurement just goes around again.
+    while (!echo_complete_) {
+        int64_t remaining_us = active_timeout_us_ - (esp_timer_get_time() - trigger_time_us_);
+        if (remaining_us <= 0) {
+            break;
+        }
+        TickType_t wait_ticks = pdMS_TO_TICKS((remaining_us + 999) / 1000) + 1;
+        xSemaphoreTake(echo_done_, wait_ticks);
+    }
+
+    return finish_measurement(distance);
+}
+
+driver::UltrasonicSensor::Status driver::UltrasonicSensor::wait_for_echo_idle() {
+    // After a measurement gives up early the module keeps the echo line high until
+    // its own echo ends (up to ~38 ms with no target) and ignores triggers until
+    // then. Firing into that would time the tail of the old pulse.
+    int64_t start_us = esp_timer_get_time();
+    while (echo_gpio_.read()) {
+        if (esp_timer_get_time() - start_us > ECHO_IDLE_TIMEOUT_US) {
+            return Status::Error;   // Stuck high: wiring fault or no sensor
+        }
+        vTaskDelay(1);
+    }
+    return Status::Success;
+}
+
 void driver::UltrasonicSensor::send_trigger_pulse() {
+    TRACE_SCOPE("ultrasonic.trigger");
+
     // Ensure trigger is low
     trigger_gpio_.set_low();
     esp_rom_delay_us(TRIGGER_SETTLE_US);
@@ -105,13 +276,16 @@ void driver::UltrasonicSensor::send_trigger_pulse() {
     trigger_gpio_.set_low();
 }
 
-driver::UltrasonicSensor::Status driver::UltrasonicSensor::measure_echo_pulse(uint32_t& pulse_duration_us) {
+driver::UltrasonicSensor::Status driver::UltrasonicSensor::measure_echo_pulse(uint32_t& pulse_duration_us,
+                                                                           uint32_t timeout_us) {
+    TRACE_SCOPE("ultrasonic.echo_poll");
+
     uint64_t start_time, end_time;
     uint64_t timeout_start = esp_timer_get_time();
     
     // Wait for echo pin to go high (start of echo)
     while (!echo_gpio_.read()) {
-        if ((esp_timer_get_time() - timeout_start) > timeout_us_) {
+        if ((esp_timer_get_time() - timeout_start) > timeout_us) {
             return Status::Timeout;
         }
     }
@@ -119,7 +293,7 @@ driver::UltrasonicSensor::Status driver::UltrasonicSensor::measure_echo_pulse(ui
     
     // Wait for echo pin to go low (end of echo)
     while (echo_gpio_.read()) {
-        if ((esp_timer_get_time() - timeout_start) > timeout_us_) {
+        if ((esp_timer_get_time() - timeout_start) > timeout_us) {
             return Status::Timeout;
         }
     }
@@ -127,14 +301,85 @@ driver::UltrasonicSensor::Status driver::UltrasonicSensor::measure_echo_pulse(ui
     
     pulse_duration_us = static_cast<uint32_t>(end_time - start_time);
     
+    return check_pulse(pulse_duration_us, timeout_us);
+}
+
+void driver::UltrasonicSensor::arm_echo_capture() {
+    echo_armed_ = false;
+    echo_complete_ = false;
+    echo_rise_us_ = -1;
+    echo_fall_us_ = -1;
+
+    // Drop a completion left over from a previous measurement that timed out
+    xSemaphoreTake(echo_done_, 0);
+
+    echo_armed_ = true;
+}
+
+driver::UltrasonicSensor::Status driver::UltrasonicSensor::finish_measurement(float& distance) {
+    measurement_active_ = false;
+    echo_armed_ = false;
+    notify_task_ = nullptr;
+    if (deadline_timer_ != nullptr) {
+        esp_timer_stop(deadline_timer_);
+    }
+
+    if (!echo_complete_) {
+        return Status::Timeout;
+    }
+
+    uint32_t pulse_duration_us = static_cast<uint32_t>(echo_fall_us_ - echo_rise_us_);
+    Status status = check_pulse(pulse_duration_us, active_timeout_us_);
+    if (status != Status::Success) {
+        return status;
+    }
+
+    distance = pulse_to_distance(pulse_duration_us);
+    return Status::Success;
+}
+
+driver::UltrasonicSensor::Status driver::UltrasonicSensor::check_pulse(uint32_t pulse_duration_us,
+                                                                    uint32_t timeout_us) const {
     // Sanity check: pulse should be reasonable duration
-    if (pulse_duration_us < 150 || pulse_duration_us > timeout_us_) {
+    if (pulse_duration_us < MIN_PULSE_US || pulse_duration_us > timeout_us) {
         return Status::OutOfRange;
     }
     
     return Status::Success;
 }
 
+void IRAM_ATTR driver::UltrasonicSensor::on_echo_edge(bool level, int64_t timestamp_us) {
+    if (!echo_armed_) {
+        return;
+    }
+
+    if (level) {
+        echo_rise_us_ = timestamp_us;
+    } else if (echo_rise_us_ >= 0) {
+        // Falling edge after a rising edge: the pulse is complete
+        echo_fall_us_ = timestamp_us;
+        echo_armed_ = false;
+        echo_complete_ = true;
+
+        BaseType_t higher_priority_woken = pdFALSE;
+        xSemaphoreGiveFromISR(echo_done_, &higher_priority_woken);
+        if (notify_task_ != nullptr) {
+            vTaskNotifyGiveFromISR(notify_task_, &higher_priority_woken);
+        }
+        portYIELD_FROM_ISR(higher_priority_woken);
+    }
+}
+
+void driver::UltrasonicSensor::deadline_handler(void* arg) {
+    auto* sensor = static_cast<UltrasonicSensor*>(arg);
+    xSemaphoreGive(sensor->echo_done_);
+}
+
+void IRAM_ATTR driver::UltrasonicSensor::echo_isr_handler(void* arg) {
+    auto* sensor = static_cast<UltrasonicSensor*>(arg);
+    sensor->on_echo_edge(gpio_get_level(sensor->echo_gpio_.pin()), esp_timer_get_time());
+}
+
 float driver::UltrasonicSensor::pulse_to_distance(uint32_t pulse_duration_us) {
     // Distance = (pulse_duration * speed_of_sound) / 2
     // Divide by 2 because sound travels to object and back
@@ -0,0 +1,143 @@
+#include "ultrasonic_array.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <numeric>
+
+driver::UltrasonicArray::UltrasonicArray(const std::vector<SensorPins>& pins,
+                                         const std::vector<uint32_t>& crosstalk,
+                                         uint32_t timeout_us)
+    : snapshot_mutex_(xSemaphoreCreateMutex())
+{
+    size_t count = std::min(pins.size(), MAX_SENSORS);
+    sensors_.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        sensors_.push_back(std::make_unique<UltrasonicSensor>(
+            pins[i].trigger_pin, pins[i].echo_pin, timeout_us,
+            UltrasonicSensor::EchoMode::Interrupt));
+    }
+
+    build_groups(crosstalk);
+
+    latest_.count = count;
+    latest_.status.fill(Status::Error);
+}
+
+driver::UltrasonicArray::~UltrasonicArray() {
+    if (snapshot_mutex_ != nullptr) {
+        vSemaphoreDelete(snapshot_mutex_);
+    }
+}
+
+void driver::UltrasonicArray::build_groups(const std::vector<uint32_t>& crosstalk) {
+    const size_t count = sensors_.size();
+
+    // Make the matrix symmetric: if i hears j, j and i must not fire together
+    std::vector<uint32_t> conflicts(count, 0);
+    for (size_t i = 0; i < count && i < crosstalk.size(); ++i) {
+        for (size_t j = 0; j < count; ++j) {
+            if (i != j && (crosstalk[i] & (1UL << j))) {
+                conflicts[i] |= 1UL << j;
+                conflicts[j] |= 1UL << i;
+            }
+        }
+    }
+
+    // Greedy graph coloring, most-constrained sensors first
+    std::vector<size_t> order(count);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return __builtin_popcount(conflicts[a]) > __builtin_popcount(conflicts[b]);
+    });
+
+    groups_.clear();
+    for (size_t sensor : order) {
+        auto group = std::find_if(groups_.begin(), groups_.end(), [&](uint32_t members) {
+            return (members & conflicts[sensor]) == 0;
+        });
+        if (group == groups_.end()) {
+            groups_.push_back(1UL << sensor);
+        } else {
+            *group |= 1UL << sensor;
+        }
+    }
+}
+
+driver::UltrasonicArray::Status driver::UltrasonicArray::sweep(Snapshot& snapshot) {
+    const size_t count = sensors_.size();
+    snapshot.count = count;
+    snapshot.distance_cm.fill(0.0f);
+    snapshot.status.fill(Status::Error);
+
+    for (uint32_t group : groups_) {
+        measure_group(group, snapshot);
+    }
+
+    snapshot.sweep_id = ++sweep_count_;
+    snapshot.timestamp_us = esp_timer_get_time();
+
+    // Publish for readers on other tasks
+    xSemaphoreTake(snapshot_mutex_, portMAX_DELAY);
+    latest_ = snapshot;
+    xSemaphoreGive(snapshot_mutex_);
+
+    bool any_valid = std::any_of(snapshot.status.begin(), snapshot.status.begin() + count,
+                                 [](Status s) { return s == Status::Success; });
+    return any_valid ? Status::Success : Status::Error;
+}
+
+void driver::UltrasonicArray::measure_group(uint32_t group, Snapshot& snapshot) {
+    const size_t count = sensors_.size();
+    uint32_t started = 0;
+
+    // Fire every sensor in the group back to back so their echoes overlap
+    for (size_t i = 0; i < count; ++i) {
+        if (!(group & (1UL << i))) {
+            continue;
+        }
+        Status status = sensors_[i]->start_measurement();
+        if (status == Status::Success) {
+            started |= 1UL << i;
+        } else {
+            snapshot.status[i] = status;
+        }
+    }
+
+    // Collect the results; the first wait covers the flight time of all of them
+    for (size_t i = 0; i < count; ++i) {
+        if (!(group & (1UL << i))) {
+            continue;
+        }
+        // Only a Polling sensor measures on its own; in Interrupt mode a failed
+        // start is a stuck echo line and a blocking retry would wait it out again
+        float distance = 0.0f;
+        Status status = snapshot.status[i];
+        if (started & (1UL << i)) {
+            status = sensors_[i]->wait_measurement(distance);
+        } else if (sensors_[i]->get_echo_mode() == UltrasonicSensor::EchoMode::Polling) {
+            status = sensors_[i]->measure_distance(distance);
+        }
+        snapshot.status[i] = status;
+        if (status == Status::Success) {
+            snapshot.distance_cm[i] = distance;
+        }
+    }
+}
+
+driver::UltrasonicArray::Snapshot driver::UltrasonicArray::latest_snapshot() const {
+    xSemaphoreTake(snapshot_mutex_, portMAX_DELAY);
+    Snapshot copy = latest_;
+    xSemaphoreGive(snapshot_mutex_);
+    return copy;
+}
+
+size_t driver::UltrasonicArray::size() const {
+    return sensors_.size();
+}
+
+size_t driver::UltrasonicArray::group_count() const {
+    return groups_.size();
+}
+
+driver::UltrasonicSensor& driver::UltrasonicArray::sensor(size_t index) {
+    return *sensors_[index];
+}
@@ -0,0 +1,731 @@
+// Host benchmark runner for the data logger: the firmware's drivers against
+// simulated I2C devices, with every number taken from the virtual clock.
+//
+// Usage: data_logger_bench > bench.csv
+//
+// Prints "metric,value,unit" rows: how long single transfers hold the bus at
+// each device's SCL speed; bus utilization, queue latency and merged transfers
+// while a temperature reader shares the bus with a stream of 64-byte EEPROM
+// reads; compression ratio, host encode/decode cost and days of buffering for
+// the record codec on synthetic warehouse traces; and for the record log, write
+// cycles per record, page wear after several laps, mount time and what a power
+// cut during a page write costs; bulk export throughput against per-record
+// reads, with CRC checks and resumes; and boot-to-ready time with the log mounted.
+#include "i2c_bus.h"
+#include "temperature_sensor.h"
+#include "eeprom.h"
+#include "eeprom_storage.h"
+#include "data_logger_app.h"
+#include "deep_sleep_logger.h"
+#include "eeprom_model.h"
+#include "tmp100_model.h"
+#include "warehouse_trace.h"
+#include "sim/i2c.h"
+#include "sim/kernel.h"
+#include "esp_timer.h"
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+
+namespace {
+
+constexpr uint16_t TMP100_ADDRESS = 0x48;
+constexpr uint16_t EEPROM_ADDRESS = 0x50;
+constexpr uint32_t EEPROM_SCL_HZ = 1000000;
+
+// Warehouse air: 4 C with a slow 1.5 C swing
+float warehouse_scene(int64_t time_us) {
+    return 4.0f + 1.5f * std::sin(time_us / 3.6e9f);
+}
+
+void print_metric(const char* name, double value, const char* unit) {
+    printf("%s,%.2f,%s\n", name, value, unit);
+}
+
+// Run fn as a FreeRTOS task and let the simulation run until it returns
+void run_task(const char* name, std::function<void()> fn, UBaseType_t priority = 4) {
+    struct Job {
+        std::function<void()> fn;
+        std::atomic<bool> done{false};
+    } job;
+    job.fn = std::move(fn);
+
+    xTaskCreate([](void* arg) {
+        Job* job = static_cast<Job*>(arg);
+        job->fn();
+        job->done = true;
+        vTaskDelete(nullptr);
+    }, name, 4096, &job, priority, nullptr);
+
+    while (!job.done) {
+        sim::run_until(sim::now_us() + 100000);
+    }
+}
+
+// Virtual time fn() takes
+template <typename Fn>
+double elapsed_us(Fn&& fn) {
+    int64_t start_us = esp_timer_get_time();
+    fn();
+    return static_cast<double>(esp_timer_get_time() - start_us);
+}
+
+// === Single transfers ===
+void run_transfers(driver::I2cBus& bus) {
+    driver::TemperatureSensor sensor(bus, TMP100_ADDRESS);
+    float celsius = 0.0f;
+    print_metric("i2c.tmp100_read_400khz", elapsed_us([&] { sensor.read_temperature(celsius); }), "us");
+
+    // The same page write at 1 MHz and at the 400 kHz a shared bus would otherwise run at
+    driver::I2cDevice* eeprom = bus.add_device(EEPROM_ADDRESS, EEPROM_SCL_HZ);
+    driver::I2cDevice* eeprom_slow = bus.add_device(EEPROM_ADDRESS, 400000);
+    uint8_t page[2 + 64] = {0x00, 0x00};
+    print_metric("i2c.eeprom_page_write_1mhz", elapsed_us([&] { eeprom->write(page, sizeof(page)); }), "us");
+    vTaskDelay(1);      // let the write cycle finish
+    print_metric("i2c.eeprom_page_write_400khz",
+                 elapsed_us([&] { eeprom_slow->write(page, sizeof(page)); }), "us");
+    vTaskDelay(1);
+
+    uint8_t buffer[64];
+    print_metric("i2c.eeprom_read_64b_1mhz",
+                 elapsed_us([&] { eeprom->write_read(page, 2, buffer, sizeof(buffer)); }), "us");
+    print_metric("i2c.probe_busy_nack", elapsed_us([&] {
+        eeprom->write(page, sizeof(page));
+        eeprom->probe();
+    }) , "us");
+    vTaskDelay(1);
+}
+
+// === Shared bus under load ===
+// A reader streams 64-byte EEPROM reads back to back while the temperature task
+// samples every 10 ms, once with write_read() and once as a pointer write and a
+// read submitted separately (which the bus merges when both are queued)
+void run_contention(driver::I2cBus& bus) {
+    driver::I2cDevice* eeprom = bus.add_device(EEPROM_ADDRESS, EEPROM_SCL_HZ);
+    driver::I2cDevice* tmp100 = bus.add_device(TMP100_ADDRESS, driver::TemperatureSensor::SCL_SPEED_HZ);
+
+    constexpr int SAMPLES = 100;
+
+    struct Reader {
+        driver::I2cDevice* device;
+        std::atomic<bool> running{true};
+        std::atomic<bool> stopped{false};
+    } reader;
+    reader.device = eeprom;
+
+    xTaskCreate([](void* arg) {
+        Reader* reader = static_cast<Reader*>(arg);
+        uint8_t address[2] = {};
+        uint8_t buffer[64];
+        uint16_t next = 0;
+        while (reader->running) {
+            address[0] = next >> 8;
+            address[1] = next & 0xFF;
+            reader->device->write_read(address, sizeof(address), buffer, sizeof(buffer));
+            next = (next + sizeof(buffer)) % host::EepromModel::SIZE;
+        }
+        reader->stopped = true;
+        vTaskDelete(nullptr);
+    }, "eeprom_reader", 4096, &reader, 3, nullptr);
+
+    bus.reset_stats();
+    for (int i = 0; i < SAMPLES; ++i) {
+        uint8_t pointer = 0;
+        uint8_t raw[2];
+        tmp100->write_read(&pointer, 1, raw, sizeof(raw));
+        vTaskDelay(1);
+    }
+    driver::I2cBus::Stats combined = bus.stats();
+
+    bus.reset_stats();
+    for (int i = 0; i < SAMPLES; ++i) {
+        uint8_t pointer = 0;
+        uint8_t raw[2];
+        driver::I2cTransaction set_pointer;
+        set_pointer.write_data = &pointer;
+        set_pointer.write_len = 1;
+        set_pointer.mergeable = true;
+        driver::I2cTransaction read;
+        read.read_data = raw;
+        read.read_len = sizeof(raw);
+        tmp100->submit(set_pointer);
+        tmp100->submit(read);
+        tmp100->wait(set_pointer);
+        tmp100->wait(read);
+        vTaskDelay(1);
+    }
+    driver::I2cBus::Stats split = bus.stats();
+    reader.running = false;
+    while (!reader.stopped) {
+        vTaskDelay(1);
+    }
+
+    print_metric("contention.utilization", combined.utilization() * 100.0, "%");
+    print_metric("contention.queue_mean", combined.mean_queue_us(), "us");
+    print_metric("contention.queue_max", static_cast<double>(combined.max_queue_us), "us");
+    print_metric("contention.transactions_per_s", combined.transactions / (combined.elapsed_us / 1e6), "1/s");
+    print_metric("contention.split_read.merged", static_cast<double>(split.merged), "pairs");
+    print_metric("contention.split_read.samples", SAMPLES, "pairs");
+    print_metric("contention.errors", static_cast<double>(combined.errors + split.errors), "transfers");
+}
+
+// === Write completion ===
+// A writer task programs pages back to back while this task reads the TMP100
+// once a tick. The part's write cycle varies between 3 and 5 ms (set in main).
+void run_write_wait(const char* name, driver::Eeprom::WriteWait wait) {
+    constexpr uint32_t PAGES = 200;
+    driver::I2cBus bus(driver::I2cBus::Config{});
+    driver::Eeprom eeprom(bus, EEPROM_ADDRESS, wait);
+    driver::TemperatureSensor sensor(bus, TMP100_ADDRESS);
+    vTaskDelay(1);      // no write cycle left over from earlier runs
+
+    struct Writer {
+        driver::Eeprom* eeprom;
+        int64_t elapsed_us = 0;
+        std::atomic<bool> stopped{false};
+    } writer;
+    writer.eeprom = &eeprom;
+
+    bus.reset_stats();
+    xTaskCreate([](void* arg) {
+        Writer* writer = static_cast<Writer*>(arg);
+        uint8_t page[driver::Eeprom::PAGE_SIZE] = {};
+        int64_t start_us = esp_timer_get_time();
+        for (uint32_t i = 0; i < PAGES; ++i) {
+            page[0] = static_cast<uint8_t>(i);
+            writer->eeprom->write_page(i, page);
+        }
+        // The last page only counts once it is programmed
+        writer->eeprom->read(0, page, 1);
+        writer->elapsed_us = esp_timer_get_time() - start_us;
+        writer->stopped = true;
+        vTaskDelete(nullptr);
+    }, "eeprom_writer", 4096, &writer, 3, nullptr);
+
+    int64_t sensor_max_us = 0;
+    int64_t sensor_total_us = 0;
+    uint32_t sensor_reads = 0;
+    while (!writer.stopped) {
+        float celsius = 0.0f;
+        int64_t start_us = esp_timer_get_time();
+        sensor.read_temperature(celsius);
+        int64_t read_us = esp_timer_get_time() - start_us;
+        sensor_max_us = std::max(sensor_max_us, read_us);
+        sensor_total_us += read_us;
+        sensor_reads++;
+        vTaskDelay(1);
+    }
+    driver::I2cBus::Stats bus_stats = bus.stats();
+    const driver::Eeprom::WriteStats& stats = eeprom.write_stats();
+
+    char metric[64];
+    snprintf(metric, sizeof(metric), "write_wait.%s.pages_per_s", name);
+    print_metric(metric, PAGES / (writer.elapsed_us / 1e6), "pages/s");
+    snprintf(metric, sizeof(metric), "write_wait.%s.write_mean", name);
+    print_metric(metric, stats.mean_write_us(), "us");
+    snprintf(metric, sizeof(metric), "write_wait.%s.write_max", name);
+    print_metric(metric, static_cast<double>(stats.max_write_us), "us");
+    if (wait == driver::Eeprom::WriteWait::AckPolling) {
+        snprintf(metric, sizeof(metric), "write_wait.%s.cycle_mean", name);
+        print_metric(metric, stats.mean_cycle_us(), "us");
+        snprintf(metric, sizeof(metric), "write_wait.%s.cycle_max", name);
+        print_metric(metric, static_cast<double>(stats.max_cycle_us), "us");
+        snprintf(metric, sizeof(metric), "write_wait.%s.polls_per_write", name);
+        print_metric(metric, static_cast<double>(stats.polls) / stats.writes, "polls");
+    }
+    snprintf(metric, sizeof(metric), "write_wait.%s.utilization", name);
+    print_metric(metric, bus_stats.utilization() * 100.0, "%");
+    snprintf(metric, sizeof(metric), "write_wait.%s.tmp100_read_mean", name);
+    print_metric(metric, static_cast<double>(sensor_total_us) / sensor_reads, "us");
+    snprintf(metric, sizeof(metric), "write_wait.%s.tmp100_read_max", name);
+    print_metric(metric, static_cast<double>(sensor_max_us), "us");
+    snprintf(metric, sizeof(metric), "write_wait.%s.errors", name);
+    print_metric(metric, static_cast<double>(bus_stats.errors), "transfers");
+}
+
+// === Record codec ===
+// Host CPU time per call of fn, in ns
+template <typename Fn>
+double host_ns(size_t calls, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    fn();
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+}
+
+void run_codec() {
+    constexpr size_t RECORDS = 20000;
+    constexpr size_t RAW_RECORD_SIZE = 8;      // uint32 timestamp + float
+    constexpr size_t PAYLOAD = driver::EepromStorage::PAYLOAD_SIZE;
+    constexpr size_t PAGES = host::EepromModel::PAGE_COUNT;
+
+    for (host::Trace trace : {host::Trace::ColdRoom, host::Trace::Ambient, host::Trace::DockDoor}) {
+        std::vector<util::Record> records = host::make_trace(trace, RECORDS, 42);
+
+        // Encode into page payloads the way EepromStorage fills them
+        std::vector<std::vector<uint8_t>> pages;
+        util::RecordEncoder encoder(PAYLOAD);
+        size_t payload_bytes = 0;
+        double encode_ns = host_ns(RECORDS, [&] {
+            for (const util::Record& record : records) {
+                if (!encoder.append(record)) {
+                    pages.emplace_back(encoder.data(), encoder.data() + encoder.size());
+                    payload_bytes += encoder.size();
+                    encoder.clear();
+                    encoder.append(record);
+                }
+            }
+        });
+        pages.emplace_back(encoder.data(), encoder.data() + encoder.size());
+        payload_bytes += encoder.size();
+
+        size_t mismatches = 0;
+        size_t decoded = 0;
+        double decode_ns = host_ns(RECORDS, [&] {
+            for (const std::vector<uint8_t>& page : pages) {
+                util::RecordDecoder decoder(page.data(), page.size());
+                util::Record record;
+                while (decoder.next(record)) {
+                    const util::Record& expected = records[decoded++];
+                    if (record.timestamp_s != expected.timestamp_s || record.celsius != expected.celsius) {
+                        mismatches++;
+                    }
+                }
+            }
+        });
+
+        double per_page = static_cast<double>(RECORDS) / pages.size();
+        char name[64];
+        auto metric = [&](const char* suffix, double value, const char* unit) {
+            snprintf(name, sizeof(name), "codec.%s.%s", host::trace_name(trace), suffix);
+            print_metric(name, value, unit);
+        };
+        metric("bytes_per_record", static_cast<double>(payload_bytes) / RECORDS, "bytes");
+        metric("compression_ratio", static_cast<double>(RAW_RECORD_SIZE * RECORDS) / payload_bytes, "x");
+        metric("records_per_page", per_page, "records");
+        metric("days_buffered", PAGES * per_page / 144.0, "days");
+        metric("encode", encode_ns, "host ns/record");
+        metric("decode", decode_ns, "host ns/record");
+        metric("mismatches", static_cast<double>(mismatches + (RECORDS - decoded)), "records");
+    }
+
+    // Corrupt pages: a tag byte the encoder never writes (0x81-0xFF) or an escape
+    // cut off inside its varints must end decoding, not yield a record
+    util::RecordEncoder encoder(PAYLOAD);
+    encoder.append({1000, 21.5f});
+    size_t accepted = 0;
+    auto decode_after_base = [&](std::initializer_list<uint8_t> tail) {
+        std::vector<uint8_t> page(encoder.data(), encoder.data() + util::RecordEncoder::BASE_SIZE);
+        page.insert(page.end(), tail);
+        page.push_back(0x00);       // a valid record after the corrupt one
+        util::RecordDecoder decoder(page.data(), page.size());
+        util::Record record;
+        decoder.next(record);
+        while (decoder.next(record)) {
+            accepted++;
+        }
+    };
+    for (unsigned tag = 0x81; tag <= 0xFF; ++tag) {
+        decode_after_base({static_cast<uint8_t>(tag)});
+    }
+    decode_after_base({0x80, 0x80});    // jitter varint never ends
+    print_metric("codec.malformed.records_accepted", static_cast<double>(accepted), "records");
+
+    // Unencoded: eight bytes per record
+    double raw_per_page = static_cast<double>(PAYLOAD / RAW_RECORD_SIZE);
+    print_metric("codec.raw.records_per_page", raw_per_page, "records");
+    print_metric("codec.raw.days_buffered", PAGES * raw_per_page / 144.0, "days");
+}
+
+// === Record log ===
+// Runs on I2C1 with its own blank EEPROM so the transfer tests above don't matter
+constexpr i2c_port_num_t STORAGE_PORT = I2C_NUM_1;
+
+driver::EepromStorage::Record sample_record(uint32_t index) {
+    uint32_t timestamp_s = index * 600;
+    float celsius = warehouse_scene(static_cast<int64_t>(timestamp_s) * 1000000);
+    return {timestamp_s, util::RecordEncoder::to_celsius(util::RecordEncoder::to_steps(celsius))};
+}
+
+// Records that read back wrong between first_index() and end_index()
+uint32_t count_bad_records(driver::EepromStorage& storage) {
+    uint32_t bad = 0;
+    for (uint32_t i = storage.first_index(); i < storage.end_index(); ++i) {
+        driver::EepromStorage::Record record;
+        driver::EepromStorage::Record expected = sample_record(i);
+        if (storage.read_record(i, record) != driver::EepromStorage::Status::Success ||
+            record.timestamp_s != expected.timestamp_s || record.celsius != expected.celsius) {
+            bad++;
+        }
+    }
+    return bad;
+}
+
+// Mount a second EepromStorage on the same device, as after a reset
+void report_mount(const char* name, driver::Eeprom& eeprom) {
+    vTaskDelay(1);      // a reset outlasts the last write cycle
+    driver::EepromStorage storage(eeprom);
+    char metric[64];
+    snprintf(metric, sizeof(metric), "storage.mount_%s", name);
+    print_metric(metric, elapsed_us([&] { storage.mount(); }) / 1e3, "ms");
+    snprintf(metric, sizeof(metric), "storage.mount_%s.reads", name);
+    print_metric(metric, static_cast<double>(storage.stats().pages_read + storage.stats().headers_read), "reads");
+}
+
+// Power fails while the next page is programmed; then the logger reboots
+void report_power_cut(const char* name, host::EepromModel& model, driver::EepromStorage& storage) {
+    model.tear_next_write();
+    uint64_t pages_before = storage.stats().pages_written;
+    while (storage.stats().pages_written == pages_before) {
+        storage.append_record(sample_record(storage.end_index()));
+    }
+    uint32_t first_before = storage.first_index();
+    uint32_t end_before = storage.end_index();
+    storage.mount();
+
+    char metric[64];
+    snprintf(metric, sizeof(metric), "storage.%s.records_lost", name);
+    print_metric(metric, end_before - storage.end_index(), "records");
+    // Beyond the page the wrap had already given up
+    snprintf(metric, sizeof(metric), "storage.%s.oldest_lost", name);
+    print_metric(metric, storage.first_index() - first_before, "records");
+    snprintf(metric, sizeof(metric), "storage.%s.bad_records", name);
+    print_metric(metric, count_bad_records(storage), "records");
+
+    // Logging carries on over the torn page
+    while (storage.stats().pages_written < 2) {
+        storage.append_record(sample_record(storage.end_index()));
+    }
+    snprintf(metric, sizeof(metric), "storage.%s.bad_after_resume", name);
+    print_metric(metric, count_bad_records(storage), "records");
+}
+
+void run_storage(host::EepromModel& model) {
+    driver::I2cBus::Config config;
+    config.port = STORAGE_PORT;
+    driver::I2cBus bus(config);
+    driver::Eeprom eeprom(bus);
+
+    report_mount("empty", eeprom);
+    driver::EepromStorage storage(eeprom);
+    storage.mount();
+
+    // Three laps around the device, remounting part way through the first
+    uint32_t records = 0;
+    uint64_t cycles_before = model.write_cycles();
+    double append_us = elapsed_us([&] {
+        while (storage.stats().pages_written < 3 * storage.page_count()) {
+            storage.append_record(sample_record(records++));
+            if (storage.stats().pages_written == 100 && storage.pending_count() == 1) {
+                report_mount("partial", eeprom);
+            }
+        }
+    });
+    print_metric("storage.records_stored", storage.end_index() - storage.first_index(), "records");
+    print_metric("storage.append_mean", append_us / records, "us");
+    print_metric("storage.write_cycles_per_record",
+                 static_cast<double>(model.write_cycles() - cycles_before) / records, "cycles");
+
+    uint32_t min_wear = UINT32_MAX;
+    uint32_t max_wear = 0;
+    for (size_t page = 0; page < host::EepromModel::PAGE_COUNT; ++page) {
+        min_wear = std::min(min_wear, model.page_writes(page));
+        max_wear = std::max(max_wear, model.page_writes(page));
+    }
+    print_metric("storage.page_wear_min", min_wear, "writes");
+    print_metric("storage.page_wear_max", max_wear, "writes");
+    print_metric("storage.bad_records", count_bad_records(storage), "records");
+
+    report_mount("full", eeprom);
+    driver::EepromStorage remounted(eeprom);
+    remounted.mount();
+    print_metric("storage.mount_full.records_lost", storage.end_index() - storage.pending_count() -
+                 remounted.end_index(), "records");
+
+    report_power_cut("power_cut", model, storage);
+
+    // The same where the log wraps from the last page to page 0
+    while (storage.next_page() != 0) {
+        storage.append_record(sample_record(storage.end_index()));
+    }
+    report_power_cut("power_cut_at_wrap", model, storage);
+    storage.flush();
+}
+
+// === Bulk export ===
+// Stand-in for the uplink: checks every chunk against its CRC and the records
+// the bench stored, and drops every refuse_every-th chunk like a flaky link
+struct CollectorSink : driver::RecordSink {
+    int refuse_every = 0;
+    int chunks = 0;
+    uint32_t expected_index = 0;
+    uint64_t received = 0;
+    uint64_t refused = 0;
+    uint64_t crc_errors = 0;
+    uint64_t mismatches = 0;
+
+    bool write(const driver::ExportChunk& chunk) override {
+        if (refuse_every > 0 && ++chunks % refuse_every == 0) {
+            refused++;
+            return false;
+        }
+        uint32_t crc = 0;
+        for (size_t i = 0; i < chunk.count; ++i) {
+            crc = driver::EepromStorage::record_crc32(chunk.records[i], crc);
+            driver::EepromStorage::Record expected = sample_record(chunk.first_index + i);
+            if (chunk.records[i].timestamp_s != expected.timestamp_s ||
+                chunk.records[i].celsius != expected.celsius) {
+                mismatches++;
+            }
+        }
+        if (crc != chunk.crc32) {
+            crc_errors++;
+        }
+        if (chunk.first_index != expected_index) {
+            mismatches++;
+        }
+        expected_index = chunk.first_index + chunk.count;
+        received += chunk.count;
+        return true;
+    }
+};
+
+// Reads back the full log run_storage() left behind
+void run_export() {
+    driver::I2cBus::Config config;
+    config.port = STORAGE_PORT;
+    driver::I2cBus bus(config);
+    driver::Eeprom eeprom(bus);
+    driver::EepromStorage storage(eeprom);
+    storage.mount();
+    uint32_t total = storage.end_index() - storage.first_index();
+    print_metric("export.records", total, "records");
+
+    // Baseline: one read_record() per record (cached page, binary search per page)
+    driver::EepromStorage::Record record;
+    double read_us = elapsed_us([&] {
+        for (uint32_t i = storage.first_index(); i < storage.end_index(); ++i) {
+            storage.read_record(i, record);
+        }
+    });
+    print_metric("export.read_record", total / (read_us / 1e6), "records/s");
+
+    // Straight into a buffer, 256 records per call
+    static driver::EepromStorage::Record buffer[256];
+    driver::ExportCursor cursor;
+    cursor.next_index = storage.first_index();
+    uint32_t exported = 0;
+    double buffer_us = elapsed_us([&] {
+        driver::ExportChunk chunk;
+        do {
+            storage.read_records(cursor, buffer, 256, chunk);
+            exported += chunk.count;
+        } while (chunk.count > 0);
+    });
+    print_metric("export.buffer_256", exported / (buffer_us / 1e6), "records/s");
+    print_metric("export.bytes_per_s", exported / (buffer_us / 1e6) * 8, "wire bytes/s");
+
+    // To a sink that drops every 7th chunk; each drop is followed by a reset
+    // (remount) and the export resumes from the saved cursor
+    CollectorSink collector;
+    collector.refuse_every = 7;
+    collector.expected_index = storage.first_index();
+    cursor = driver::ExportCursor();
+    cursor.next_index = storage.first_index();
+    int resumes = 0;
+    double sink_us = elapsed_us([&] {
+        while (storage.export_records(cursor, collector, buffer, 256) == driver::EepromStorage::Status::Stopped) {
+            resumes++;
+            storage.mount();
+        }
+    });
+    print_metric("export.sink_256", collector.received / (sink_us / 1e6), "records/s");
+    print_metric("export.sink.resumes", resumes, "resumes");
+    print_metric("export.sink.missing", total - collector.received, "records");
+    print_metric("export.sink.crc_errors", static_cast<double>(collector.crc_errors), "chunks");
+    print_metric("export.sink.mismatches", static_cast<double>(collector.mismatches), "records");
+    print_metric("export.sink.skipped", cursor.skipped, "records");
+}
+
+// === Sampling cycle ===
+// The app's own step() on the full log, sleeping the sample period in between,
+// with the store after the conversion and overlapped with it
+void run_cycles(const char* name, bool overlap_store) {
+    constexpr int CYCLES = 440;     // about ten page writes
+    driver::I2cBus::Config config;
+    config.port = STORAGE_PORT;
+    driver::I2cBus bus(config);
+    driver::TemperatureSensor sensor(bus);
+    driver::Eeprom eeprom(bus);
+    driver::EepromStorage storage(eeprom);
+    app::DataLoggerApp::Config app_config;
+    app_config.overlap_store = overlap_store;
+    app_config.verbose = false;
+    app::DataLoggerApp logger(bus, sensor, storage, app_config);
+    logger.start();
+
+    for (int i = 0; i < CYCLES; ++i) {
+        logger.step();
+        app::sleep_ms(app_config.sample_period_ms);
+    }
+    logger.flush();
+
+    const app::DataLoggerApp::CycleStats& stats = logger.cycle_stats();
+    char metric[64];
+    snprintf(metric, sizeof(metric), "cycle.%s.awake_mean", name);
+    print_metric(metric, stats.mean_awake_us() / 1e3, "ms");
+    snprintf(metric, sizeof(metric), "cycle.%s.awake_max", name);
+    print_metric(metric, static_cast<double>(stats.max_awake_us) / 1e3, "ms");
+    snprintf(metric, sizeof(metric), "cycle.%s.pages_written", name);
+    print_metric(metric, static_cast<double>(storage.stats().pages_written), "pages");
+}
+
+// === Deep sleep ===
+// Each wake-up builds the drivers from scratch as after a reset; only the
+// staging struct (RTC memory on the chip) survives from one to the next
+void run_deep_sleep(const char* name, bool stage_in_rtc) {
+    constexpr int WAKES = 220;      // about five pages
+    static app::RtcStaging staging;
+    app::DeepSleepLogger::Config logger_config;
+    logger_config.stage_in_rtc = stage_in_rtc;
+    driver::I2cBus::Config config;
+    config.port = STORAGE_PORT;
+
+    int64_t total_awake_us = 0;
+    int64_t max_awake_us = 0;
+    int64_t total_sensor_us = 0;
+    int64_t total_commit_us = 0;
+    uint32_t pages = 0;
+    uint32_t eeprom_wakes = 0;
+    uint32_t failed = 0;
+    for (int i = 0; i < WAKES; ++i) {
+        app::DeepSleepLogger::WakeReport report;
+        int64_t awake_us = static_cast<int64_t>(elapsed_us([&] {
+            driver::I2cBus bus(config);
+            driver::TemperatureSensor sensor(bus);
+            driver::Eeprom eeprom(bus);
+            driver::EepromStorage storage(eeprom);
+            app::DeepSleepLogger logger(staging, sensor, storage, logger_config);
+            report = logger.wake(i == 0);
+        }));
+        // The first wake is a cold boot, which mounts the log to find the time
+        if (i > 0) {
+            total_awake_us += awake_us;
+            max_awake_us = std::max(max_awake_us, awake_us);
+            total_sensor_us += report.sensor_us;
+            total_commit_us += report.commit_us;
+            pages += report.pages_written;
+            eeprom_wakes += report.commit_us > 0 ? 1 : 0;
+        }
+        failed += report.ok ? 0 : 1;
+        app::sleep_ms(logger_config.sample_period_ms - static_cast<uint32_t>(awake_us / 1000));
+    }
+
+    int samples = WAKES - 1;
+    char metric[64];
+    snprintf(metric, sizeof(metric), "sleep.%s.awake_mean", name);
+    print_metric(metric, total_awake_us / 1e3 / samples, "ms");
+    snprintf(metric, sizeof(metric), "sleep.%s.awake_max", name);
+    print_metric(metric, static_cast<double>(max_awake_us) / 1e3, "ms");
+    snprintf(metric, sizeof(metric), "sleep.%s.sensor_mean", name);
+    print_metric(metric, total_sensor_us / 1e3 / samples, "ms");
+    snprintf(metric, sizeof(metric), "sleep.%s.eeprom_per_commit", name);
+    print_metric(metric, eeprom_wakes > 0 ? total_commit_us / 1e3 / eeprom_wakes : 0.0, "ms");
+    snprintf(metric, sizeof(metric), "sleep.%s.eeprom_wakes", name);
+    print_metric(metric, 100.0 * eeprom_wakes / samples, "% of wakes");
+    snprintf(metric, sizeof(metric), "sleep.%s.page_writes_per_sample", name);
+    print_metric(metric, static_cast<double>(pages) / samples, "pages");
+    snprintf(metric, sizeof(metric), "sleep.%s.eeprom_per_sample", name);
+    print_metric(metric, total_commit_us / 1e3 / samples, "ms");
+    snprintf(metric, sizeof(metric), "sleep.%s.awake_per_day", name);
+    print_metric(metric, total_awake_us / 1e6 / samples * (86400000.0 / logger_config.sample_period_ms), "s");
+    snprintf(metric, sizeof(metric), "sleep.%s.failed_wakes", name);
+    print_metric(metric, failed, "wakes");
+    if (stage_in_rtc) {
+        print_metric("sleep.rtc_bytes", sizeof(app::RtcStaging), "bytes");
+    }
+
+    // A wake-up after a reset that kept RTC memory: intact staging is kept,
+    // a flipped bit in a staged reading is caught by the CRC
+    auto warm_wake = [&] {
+        driver::I2cBus bus(config);
+        driver::TemperatureSensor sensor(bus);
+        driver::Eeprom eeprom(bus);
+        driver::EepromStorage storage(eeprom);
+        app::DeepSleepLogger logger(staging, sensor, storage, logger_config);
+        return logger.wake(false).staging_reset;
+    };
+    bool kept = !warm_wake();
+    staging.records[0].timestamp_s ^= 0x100;
+    bool caught = warm_wake();
+    snprintf(metric, sizeof(metric), "sleep.%s.crc_checks_failed", name);
+    print_metric(metric, (kept ? 0 : 1) + (caught ? 0 : 1), "checks");
+}
+
+// Boot to a mounted log with the app's own start(), on a full device
+void run_boot() {
+    driver::I2cBus::Config config;
+    config.port = STORAGE_PORT;
+    double boot_us = elapsed_us([&] {
+        driver::I2cBus bus(config);
+        driver::TemperatureSensor sensor(bus);
+        driver::Eeprom eeprom(bus);
+        driver::EepromStorage storage(eeprom);
+        app::DataLoggerApp::Config app_config;
+        app_config.verbose = false;
+        app::DataLoggerApp logger(bus, sensor, storage, app_config);
+        logger.start();
+    });
+    print_metric("app.boot_to_ready", boot_us / 1e3, "ms");
+}
+
+} // namespace
+
+int main() {
+    host::Tmp100Model tmp100(warehouse_scene);
+    host::EepromModel eeprom;
+    sim::attach_i2c_device(I2C_NUM_0, TMP100_ADDRESS, &tmp100);
+    sim::attach_i2c_device(I2C_NUM_0, EEPROM_ADDRESS, &eeprom);
+
+    printf("metric,value,unit\n");
+    run_codec();
+    run_task("transfers", [] {
+        driver::I2cBus bus(driver::I2cBus::Config{});
+        run_transfers(bus);
+    });
+    run_task("contention", [] {
+        driver::I2cBus bus(driver::I2cBus::Config{});
+        run_contention(bus);
+    });
+    eeprom.set_write_cycle(3000, 5000);
+    run_task("write_fixed", [] { run_write_wait("fixed_delay", driver::Eeprom::WriteWait::FixedDelay); });
+    run_task("write_polled", [] { run_write_wait("ack_polling", driver::Eeprom::WriteWait::AckPolling); });
+
+    host::EepromModel storage_eeprom;
+    sim::attach_i2c_device(STORAGE_PORT, driver::Eeprom::DEFAULT_ADDRESS, &storage_eeprom);
+    sim::attach_i2c_device(STORAGE_PORT, TMP100_ADDRESS, &tmp100);
+    run_task("storage", [&storage_eeprom] { run_storage(storage_eeprom); });
+    run_task("export", run_export);
+    // The sampling runs use the slowest part read_result() allows for
+    tmp100.set_conversion_time(driver::TemperatureSensor::conversion_time_us(
+        driver::TemperatureSensor::Resolution::Bits12));
+    run_task("cycle_sequential", [] { run_cycles("sequential", false); });
+    run_task("cycle_overlapped", [] { run_cycles("overlapped", true); });
+    run_task("sleep_unstaged", [] { run_deep_sleep("unstaged", false); });
+    run_task("sleep_staged", [] { run_deep_sleep("staged", true); });
+    run_task("boot", run_boot);
+
+    print_metric("tmp100.stale_reads", static_cast<double>(tmp100.stale_reads()), "reads");
+
+    sim::I2cBusStats wire = sim::i2c_stats(I2C_NUM_0);
+    print_metric("wire.transfers", static_cast<double>(wire.transfers), "transfers");
+    print_metric("wire.nacks", static_cast<double>(wire.nacks), "transfers");
+
+    // Simulated tasks may still be blocked; leave without running static destructors
+    fflush(stdout);
+    std::_Exit(0);
+}
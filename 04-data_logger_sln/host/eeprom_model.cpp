@@ -0,0 +1,76 @@
+#include "eeprom_model.h"
+#include "sim/kernel.h"
+
+host::EepromModel::EepromModel()
+    : memory_(SIZE, 0xFF), wear_(PAGE_COUNT, 0)
+{
+}
+
+bool host::EepromModel::on_start(bool read) {
+    if (sim::now_us() < busy_until_us_) {
+        busy_nacks_++;
+        return false;
+    }
+    // A repeated START for a read keeps the address pointer just written
+    if (!read) {
+        write_index_ = 0;
+        data_bytes_ = 0;
+    }
+    return true;
+}
+
+bool host::EepromModel::on_write(uint8_t byte) {
+    int index = write_index_++;
+    if (index == 0) {
+        pointer_ = static_cast<uint16_t>((byte & 0x7F) << 8);
+        return true;
+    }
+    if (index == 1) {
+        pointer_ |= byte;
+        return true;
+    }
+
+    // Latch data within the page, wrapping at its end
+    size_t offset = (pointer_ + data_bytes_) % PAGE_SIZE;
+    latch_[offset] = byte;
+    latched_[offset] = true;
+    data_bytes_++;
+    return true;
+}
+
+uint8_t host::EepromModel::on_read() {
+    uint8_t value = memory_[pointer_];
+    pointer_ = (pointer_ + 1) % SIZE;
+    return value;
+}
+
+void host::EepromModel::on_stop() {
+    if (data_bytes_ == 0) {
+        return;
+    }
+
+    // Program the latched bytes of the page and leave the pointer after the last one
+    size_t page = pointer_ / PAGE_SIZE;
+    size_t programmed = tear_next_write_ ? data_bytes_ / 2 : data_bytes_;
+    for (size_t offset = 0; offset < PAGE_SIZE; ++offset) {
+        if (latched_[offset]) {
+            if (programmed > 0) {
+                memory_[page * PAGE_SIZE + offset] = latch_[offset];
+                programmed--;
+            }
+            latched_[offset] = false;
+        }
+    }
+    tear_next_write_ = false;
+    pointer_ = static_cast<uint16_t>(page * PAGE_SIZE + (pointer_ + data_bytes_) % PAGE_SIZE);
+    data_bytes_ = 0;
+    wear_[page]++;
+    write_cycles_++;
+    // Deterministic spread of cycle times (LCG), so bench runs repeat exactly
+    int64_t cycle_us = min_cycle_us_;
+    if (max_cycle_us_ > min_cycle_us_) {
+        cycle_seed_ = cycle_seed_ * 1664525u + 1013904223u;
+        cycle_us += (cycle_seed_ >> 8) % (max_cycle_us_ - min_cycle_us_ + 1);
+    }
+    busy_until_us_ = sim::now_us() + cycle_us;
+}
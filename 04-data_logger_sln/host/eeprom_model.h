@@ -0,0 +1,68 @@
+#pragma once
+#include "sim/i2c.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Host model of a Microchip 24FC256 EEPROM on the simulated I2C bus.
+//
+// A write sends a 2-byte address and up to a page of data; the data is latched
+// and programmed on STOP, which starts a WRITE_CYCLE_US internal write cycle
+// during which the part NACKs its address. Data past the end of a page wraps to
+// the start of the same page, as on the real part. Reads continue from the
+// address pointer and wrap at the end of memory.
+namespace host {
+
+class EepromModel : public sim::I2cDeviceModel {
+public:
+    static constexpr size_t SIZE = 32768;
+    static constexpr size_t PAGE_SIZE = 64;
+    static constexpr size_t PAGE_COUNT = SIZE / PAGE_SIZE;
+    static constexpr int64_t WRITE_CYCLE_US = 5000;
+
+    EepromModel();
+
+    bool on_start(bool read) override;
+    bool on_write(uint8_t byte) override;
+    uint8_t on_read() override;
+    void on_stop() override;
+
+    // Memory contents, for checking what the firmware stored
+    const uint8_t* data() const { return memory_.data(); }
+
+    // Write cycles each page has been through
+    uint32_t page_writes(size_t page) const { return wear_[page]; }
+    uint64_t write_cycles() const { return write_cycles_; }
+
+    // Address polls answered with NACK during a write cycle
+    uint64_t busy_nacks() const { return busy_nacks_; }
+
+    // Write cycles last a spread of min_us..max_us instead of WRITE_CYCLE_US.
+    // The datasheet only gives the maximum; real parts usually finish sooner.
+    void set_write_cycle(int64_t min_us, int64_t max_us) {
+        min_cycle_us_ = min_us;
+        max_cycle_us_ = max_us;
+    }
+
+    // Power fails during the next write cycle: only the first half of the latched
+    // bytes get programmed and the rest of the page keeps its old contents
+    void tear_next_write() { tear_next_write_ = true; }
+
+private:
+    std::vector<uint8_t> memory_;
+    std::vector<uint32_t> wear_;
+    uint8_t latch_[PAGE_SIZE] = {};
+    bool latched_[PAGE_SIZE] = {};
+    uint16_t pointer_ = 0;          // Address counter
+    int write_index_ = 0;           // Bytes written since START
+    size_t data_bytes_ = 0;         // Data bytes latched since START
+    int64_t busy_until_us_ = 0;     // End of the current write cycle
+    uint64_t write_cycles_ = 0;
+    uint64_t busy_nacks_ = 0;
+    bool tear_next_write_ = false;
+    int64_t min_cycle_us_ = WRITE_CYCLE_US;
+    int64_t max_cycle_us_ = WRITE_CYCLE_US;
+    uint32_t cycle_seed_ = 1;
+};
+
+} // namespace host
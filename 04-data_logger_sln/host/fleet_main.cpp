@@ -0,0 +1,392 @@
+// Fleet simulator: thousands of data-logger nodes in one process, each running
+// the real EepromStorage and record codec on a RAM-backed EEPROM with a TMP100
+// model, all uploading through export_records() to an in-process collector.
+//
+//   ./build-host/fleet_sim                         every outage pattern, 2000 nodes, 7 days
+//   ./build-host/fleet_sim site 5000 14 2000       pattern, nodes, days, collector records/s
+//
+// Time advances one sample period (10 minutes) at a time. Every period each node
+// takes a reading and appends it to its log. Then the nodes whose link is up
+// upload in turn. A node stops when it is drained, when it reaches its chunk
+// limit for the period, or when the collector's capacity for the period runs
+// out. Refused chunks stay in the node's log; the node resumes from its cursor.
+//
+// Output is CSV like the bench: metric,value,unit
+#include "eeprom_storage.h"
+#include "temperature_sensor.h"
+#include "memory_page_device.h"
+#include "tmp100_model.h"
+#include "sim/kernel.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SAMPLE_PERIOD_S = 600;
+constexpr uint32_t DAY_S = 86400;
+constexpr size_t CHUNK_RECORDS = 64;
+constexpr int CHUNKS_PER_UPLOAD = 8;        // Per node and period
+constexpr float FLAKY_DROP_RATE = 0.3f;
+
+enum class Outage {
+    None,       // Every upload gets through
+    Site,       // The whole site loses its uplink for days 2-3
+    Rolling,    // One eighth of the nodes at a time offline for 12 h, days 1-4
+    Flaky,      // Each upload attempt fails with FLAKY_DROP_RATE
+};
+
+const char* outage_name(Outage outage) {
+    switch (outage) {
+        case Outage::None: return "none";
+        case Outage::Site: return "site";
+        case Outage::Rolling: return "rolling";
+        case Outage::Flaky: return "flaky";
+    }
+    return "unknown";
+}
+
+bool parse_outage(const char* name, Outage& outage) {
+    for (Outage candidate : {Outage::None, Outage::Site, Outage::Rolling, Outage::Flaky}) {
+        if (strcmp(name, outage_name(candidate)) == 0) {
+            outage = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// When the last outage of a pattern ends, or 0 if it has no fixed end
+uint32_t outage_end_s(Outage outage) {
+    switch (outage) {
+        case Outage::Site: return 4 * DAY_S;
+        case Outage::Rolling: return 5 * DAY_S;
+        default: return 0;
+    }
+}
+
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+};
+
+struct FleetConfig {
+    size_t nodes = 2000;
+    uint32_t days = 7;
+    Outage outage = Outage::None;
+    uint32_t collector_records_per_s = 500;
+};
+
+// Stand-in for the collection server. Checks every chunk's CRC and that it
+// continues where the node's last accepted chunk ended, and has a fixed
+// capacity per period; chunks past it are refused.
+class Collector {
+public:
+    Collector(size_t nodes, uint64_t records_per_period)
+        : next_index_(nodes, 0), records_per_period_(records_per_period) {}
+
+    void start_period() {
+        budget_ = records_per_period_;
+        period_records_ = 0;
+    }
+
+    bool ingest(size_t node, const driver::ExportChunk& chunk) {
+        if (chunk.count > budget_) {
+            refused_++;
+            return false;
+        }
+        uint32_t crc = 0;
+        for (size_t i = 0; i < chunk.count; ++i) {
+            crc = driver::EepromStorage::record_crc32(chunk.records[i], crc);
+        }
+        if (crc != chunk.crc32) {
+            crc_errors_++;
+            return false;
+        }
+
+        uint32_t& next = next_index_[node];
+        if (chunk.first_index > next) {
+            gaps_ += chunk.first_index - next;
+        } else if (chunk.first_index < next) {
+            duplicates_ += next - chunk.first_index;
+        }
+        next = chunk.first_index + static_cast<uint32_t>(chunk.count);
+        budget_ -= chunk.count;
+        period_records_ += chunk.count;
+        records_ += chunk.count;
+        return true;
+    }
+
+    bool exhausted() const { return budget_ < CHUNK_RECORDS; }
+    uint64_t period_records() const { return period_records_; }
+    uint64_t records() const { return records_; }
+    uint64_t refused() const { return refused_; }
+    uint64_t crc_errors() const { return crc_errors_; }
+    uint64_t gaps() const { return gaps_; }
+    uint64_t duplicates() const { return duplicates_; }
+
+private:
+    std::vector<uint32_t> next_index_;
+    uint64_t records_per_period_;
+    uint64_t budget_ = 0;
+    uint64_t period_records_ = 0;
+    uint64_t records_ = 0;
+    uint64_t refused_ = 0;
+    uint64_t crc_errors_ = 0;
+    uint64_t gaps_ = 0;
+    uint64_t duplicates_ = 0;
+};
+
+// One logger: its EEPROM image, log and sensor, and how far it has uploaded
+struct Node {
+    host::MemoryPageDevice eeprom;
+    driver::EepromStorage storage;
+    host::Tmp100Model sensor;
+    driver::ExportCursor cursor;
+    Random random;
+
+    Node(uint32_t id, host::Tmp100Model::Scene scene)
+        : storage(eeprom), sensor(std::move(scene)), random{id * 2654435761u + 1}
+    {
+    }
+};
+
+// A node's connection for one period; hangs up after CHUNKS_PER_UPLOAD chunks
+class Uplink : public driver::RecordSink {
+public:
+    Uplink(Collector& collector, size_t node) : collector_(collector), node_(node) {}
+
+    bool write(const driver::ExportChunk& chunk) override {
+        if (chunks_ == CHUNKS_PER_UPLOAD || !collector_.ingest(node_, chunk)) {
+            return false;
+        }
+        chunks_++;
+        return true;
+    }
+
+private:
+    Collector& collector_;
+    size_t node_;
+    int chunks_ = 0;
+};
+
+// Cold rooms, offices and dock doors, each node with its own phase
+host::Tmp100Model::Scene node_scene(uint32_t id) {
+    float phase = (id * 0.618034f) - std::floor(id * 0.618034f);
+    switch (id % 3) {
+        case 0:
+            return [phase](int64_t time_us) {
+                float cycle = std::fmod(time_us / 3.0e9f + phase, 1.0f);
+                return 3.0f + 0.8f * (cycle < 0.5f ? cycle * 4.0f - 1.0f : 3.0f - cycle * 4.0f);
+            };
+        case 1:
+            return [phase](int64_t time_us) {
+                return 18.0f + 5.0f * std::sin(6.2831853f * (time_us / 8.64e10f + phase));
+            };
+        default:
+            return [phase, id](int64_t time_us) {
+                // The door is open for one 10-minute slot in 16, picked per node
+                uint32_t slot = static_cast<uint32_t>(time_us / 600000000);
+                bool open = ((slot * 2654435761u) ^ id) % 16 == 0;
+                return 12.0f + 3.0f * std::sin(6.2831853f * (time_us / 8.64e10f + phase)) + (open ? 8.0f : 0.0f);
+            };
+    }
+}
+
+// Drive the TMP100 model's bus callbacks directly, as the driver's transfers would
+void write_config(host::Tmp100Model& sensor, uint8_t config) {
+    sensor.on_start(false);
+    sensor.on_write(0x01);
+    sensor.on_write(config);
+    sensor.on_stop();
+}
+
+float read_sensor(host::Tmp100Model& sensor) {
+    sensor.on_start(false);
+    sensor.on_write(0x00);
+    sensor.on_start(true);
+    uint8_t msb = sensor.on_read();
+    uint8_t lsb = sensor.on_read();
+    sensor.on_stop();
+    return driver::TemperatureSensor::raw_to_celsius(msb, lsb);
+}
+
+bool link_up(Outage outage, size_t node, uint32_t time_s, Random& random) {
+    switch (outage) {
+        case Outage::None:
+            return true;
+        case Outage::Site:
+            return time_s < 2 * DAY_S || time_s >= 4 * DAY_S;
+        case Outage::Rolling: {
+            uint32_t start_s = DAY_S + static_cast<uint32_t>(node % 8) * (DAY_S / 2);
+            return time_s < start_s || time_s >= start_s + DAY_S / 2;
+        }
+        case Outage::Flaky:
+            return random.uniform() >= FLAKY_DROP_RATE;
+    }
+    return true;
+}
+
+// Resident set size of this process, 0 where /proc is not available
+size_t resident_bytes() {
+    FILE* file = fopen("/proc/self/statm", "r");
+    if (file == nullptr) {
+        return 0;
+    }
+    unsigned long size = 0;
+    unsigned long resident = 0;
+    int fields = fscanf(file, "%lu %lu", &size, &resident);
+    fclose(file);
+    return fields == 2 ? resident * static_cast<size_t>(sysconf(_SC_PAGESIZE)) : 0;
+}
+
+void print_metric(const char* prefix, const char* name, double value, const char* unit) {
+    printf("fleet.%s.%s,%.2f,%s\n", prefix, name, value, unit);
+}
+
+void run_fleet(const FleetConfig& config) {
+    using Clock = std::chrono::steady_clock;
+    const char* name = outage_name(config.outage);
+    int64_t base_us = sim::now_us();
+
+    size_t resident_before = resident_bytes();
+    std::vector<std::unique_ptr<Node>> nodes;
+    nodes.reserve(config.nodes);
+    for (size_t i = 0; i < config.nodes; ++i) {
+        uint32_t id = static_cast<uint32_t>(i);
+        nodes.push_back(std::make_unique<Node>(id, node_scene(id)));
+        write_config(nodes.back()->sensor, 0x60);     // 12 bits, continuous
+        nodes.back()->storage.mount();
+    }
+    size_t resident_after = resident_bytes();
+
+    Collector collector(config.nodes, static_cast<uint64_t>(config.collector_records_per_s) * SAMPLE_PERIOD_S);
+    static util::Record buffer[CHUNK_RECORDS];
+    uint32_t periods = config.days * (DAY_S / SAMPLE_PERIOD_S);
+    uint32_t outage_end = outage_end_s(config.outage);
+    uint64_t sampled = 0;
+    uint64_t peak_backlog = 0;
+    uint64_t peak_period_records = 0;
+    int64_t drain_s = -1;
+    size_t first = 0;               // Node that uploads first; starved nodes go first next time
+    Clock::duration upload_time{};
+    Clock::time_point run_start = Clock::now();
+
+    for (uint32_t period = 0; period < periods; ++period) {
+        uint32_t time_s = period * SAMPLE_PERIOD_S;
+        sim::advance_to(base_us + static_cast<int64_t>(time_s) * 1000000);
+
+        for (std::unique_ptr<Node>& node : nodes) {
+            node->storage.append_record({time_s, read_sensor(node->sensor)});
+        }
+        sampled += nodes.size();
+
+        Clock::time_point upload_start = Clock::now();
+        collector.start_period();
+        size_t next_first = first;
+        for (size_t k = 0; k < nodes.size(); ++k) {
+            size_t i = (first + k) % nodes.size();
+            Node& node = *nodes[i];
+            if (collector.exhausted()) {
+                next_first = i;
+                break;
+            }
+            if (!link_up(config.outage, i, time_s, node.random)) {
+                continue;
+            }
+            Uplink uplink(collector, i);
+            node.storage.export_records(node.cursor, uplink, buffer, CHUNK_RECORDS);
+        }
+        first = next_first;
+        upload_time += Clock::now() - upload_start;
+
+        uint64_t backlog = 0;
+        for (std::unique_ptr<Node>& node : nodes) {
+            backlog += node->storage.end_index() - node->cursor.next_index;
+        }
+        peak_backlog = std::max(peak_backlog, backlog);
+        peak_period_records = std::max(peak_period_records, collector.period_records());
+        if (outage_end > 0 && drain_s < 0 && time_s >= outage_end && backlog == 0) {
+            drain_s = time_s - outage_end;
+        }
+    }
+    double run_s = std::chrono::duration<double>(Clock::now() - run_start).count();
+    double upload_s = std::chrono::duration<double>(upload_time).count();
+
+    uint64_t skipped = 0;
+    uint64_t page_writes = 0;
+    size_t footprint = 0;
+    for (std::unique_ptr<Node>& node : nodes) {
+        skipped += node->cursor.skipped;
+        page_writes += node->eeprom.page_writes();
+        footprint += sizeof(Node) + node->eeprom.footprint();
+    }
+
+    print_metric(name, "nodes", static_cast<double>(config.nodes), "nodes");
+    print_metric(name, "days", config.days, "days");
+    print_metric(name, "records_sampled", static_cast<double>(sampled), "records");
+    print_metric(name, "records_ingested", static_cast<double>(collector.records()), "records");
+    print_metric(name, "delivered", 100.0 * collector.records() / sampled, "%");
+    print_metric(name, "ingest_host", collector.records() / upload_s, "records/s");
+    print_metric(name, "ingest_peak", static_cast<double>(peak_period_records) / SAMPLE_PERIOD_S, "records/s");
+    print_metric(name, "collector_capacity", config.collector_records_per_s, "records/s");
+    print_metric(name, "backlog_peak", static_cast<double>(peak_backlog), "records");
+    if (outage_end > 0) {
+        print_metric(name, "backlog_drain", drain_s >= 0 ? drain_s / 3600.0 : -1.0, "h after outage");
+    }
+    print_metric(name, "refused_chunks", static_cast<double>(collector.refused()), "chunks");
+    print_metric(name, "lost", static_cast<double>(skipped), "records");
+    print_metric(name, "crc_errors", static_cast<double>(collector.crc_errors()), "chunks");
+    print_metric(name, "gaps", static_cast<double>(collector.gaps()), "records");
+    print_metric(name, "duplicates", static_cast<double>(collector.duplicates()), "records");
+    print_metric(name, "page_writes_per_node", static_cast<double>(page_writes) / config.nodes, "pages");
+    print_metric(name, "memory_per_node", static_cast<double>(footprint) / config.nodes, "bytes");
+    print_metric(name, "resident_per_node", static_cast<double>(resident_after - resident_before) / config.nodes,
+                 "bytes");
+    print_metric(name, "wall_time", run_s, "s");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    FleetConfig config;
+    bool all = argc < 2;
+    if (!all && !parse_outage(argv[1], config.outage)) {
+        fprintf(stderr, "usage: %s [none|site|rolling|flaky] [nodes] [days] [collector records/s]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 2) {
+        config.nodes = static_cast<size_t>(std::max(1L, strtol(argv[2], nullptr, 10)));
+    }
+    if (argc > 3) {
+        config.days = static_cast<uint32_t>(std::max(1L, strtol(argv[3], nullptr, 10)));
+    }
+    if (argc > 4) {
+        config.collector_records_per_s = static_cast<uint32_t>(std::max(1L, strtol(argv[4], nullptr, 10)));
+    }
+
+    printf("metric,value,unit\n");
+    if (all) {
+        for (Outage outage : {Outage::None, Outage::Site, Outage::Rolling, Outage::Flaky}) {
+            config.outage = outage;
+            run_fleet(config);
+        }
+    } else {
+        run_fleet(config);
+    }
+    fflush(stdout);
+    return 0;
+}
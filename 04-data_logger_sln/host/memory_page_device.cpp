@@ -0,0 +1,29 @@
+#include "memory_page_device.h"
+#include <cstring>
+
+host::MemoryPageDevice::MemoryPageDevice(size_t page_count)
+    : memory_(page_count * PAGE_SIZE, 0xFF)
+{
+}
+
+esp_err_t host::MemoryPageDevice::read(uint32_t address, uint8_t* data, size_t len) {
+    if (address >= memory_.size()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // Sequential reads wrap at the end of memory, like the 24FC256
+    size_t first = len < memory_.size() - address ? len : memory_.size() - address;
+    memcpy(data, memory_.data() + address, first);
+    for (size_t i = first; i < len; ++i) {
+        data[i] = memory_[(address + i) % memory_.size()];
+    }
+    return ESP_OK;
+}
+
+esp_err_t host::MemoryPageDevice::write_page(uint32_t page, const uint8_t* data) {
+    if (page >= page_count()) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memcpy(memory_.data() + page * PAGE_SIZE, data, PAGE_SIZE);
+    page_writes_++;
+    return ESP_OK;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include "page_device.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// RAM-backed PageDevice with the 24FC256's geometry, for running EepromStorage
+// without a simulated I2C bus (e.g. thousands of nodes in the fleet simulator).
+// Reads and writes take no virtual time.
+namespace host {
+
+class MemoryPageDevice : public driver::PageDevice {
+public:
+    static constexpr size_t PAGE_SIZE = 64;
+    static constexpr size_t DEFAULT_PAGE_COUNT = 512;
+
+    explicit MemoryPageDevice(size_t page_count = DEFAULT_PAGE_COUNT);
+
+    esp_err_t read(uint32_t address, uint8_t* data, size_t len) override;
+    esp_err_t write_page(uint32_t page, const uint8_t* data) override;
+
+    size_t page_size() const override { return PAGE_SIZE; }
+    size_t page_count() const override { return memory_.size() / PAGE_SIZE; }
+
+    uint64_t page_writes() const { return page_writes_; }
+
+    // Bytes of host memory the image takes
+    size_t footprint() const { return memory_.capacity(); }
+
+private:
+    std::vector<uint8_t> memory_;
+    uint64_t page_writes_ = 0;
+};
+
+} // namespace host
@@ -0,0 +1,92 @@
+#include "tmp100_model.h"
+#include "sim/kernel.h"
+#include <cmath>
+
+host::Tmp100Model::Tmp100Model(Scene scene)
+    : scene_(std::move(scene))
+{
+}
+
+bool host::Tmp100Model::on_start(bool read) {
+    write_index_ = 0;
+    read_index_ = 0;
+    if (read) {
+        reads_++;
+        switch (pointer_) {
+            case 0:
+                read_value_ = temperature_register();
+                stale_reads_ += one_shot_done_us_ >= 0 ? 1 : 0;
+                break;
+            case 1: read_value_ = static_cast<uint16_t>(config_ << 8); break;
+            case 2: read_value_ = t_low_; break;
+            default: read_value_ = t_high_; break;
+        }
+    }
+    return true;
+}
+
+bool host::Tmp100Model::on_write(uint8_t byte) {
+    int index = write_index_++;
+    if (index == 0) {
+        pointer_ = byte & 0x3;
+        return true;
+    }
+
+    // Register data, MSB first; the configuration register is a single byte
+    switch (pointer_) {
+        case 0: return false;   // read-only
+        case 1: if (index == 1) write_config(byte); break;
+        case 2: t_low_ = index == 1 ? (byte << 8) | (t_low_ & 0xFF) : (t_low_ & 0xFF00) | byte; break;
+        default: t_high_ = index == 1 ? (byte << 8) | (t_high_ & 0xFF) : (t_high_ & 0xFF00) | byte; break;
+    }
+    return true;
+}
+
+uint8_t host::Tmp100Model::on_read() {
+    // Reads past the second byte repeat the register
+    int index = read_index_++ & 1;
+    return index == 0 ? read_value_ >> 8 : read_value_ & 0xFF;
+}
+
+int64_t host::Tmp100Model::conversion_us() const {
+    int bits = 9 + ((config_ >> 5) & 0x3);
+    return conversion_12bit_us_ >> (12 - bits);
+}
+
+void host::Tmp100Model::write_config(uint8_t config) {
+    constexpr uint8_t SHUTDOWN = 0x01;
+    constexpr uint8_t ONE_SHOT = 0x80;
+
+    // Entering shutdown keeps the last continuous result
+    if ((config & SHUTDOWN) && !(config_ & SHUTDOWN)) {
+        result_ = temperature_register();
+    }
+    config_ = config & ~ONE_SHOT;     // OS reads back as ALERT, which stays 0 here
+    if ((config & SHUTDOWN) && (config & ONE_SHOT)) {
+        temperature_register();       // finish a one-shot still running
+        one_shot_done_us_ = sim::now_us() + conversion_us();
+        one_shots_++;
+    }
+}
+
+uint16_t host::Tmp100Model::temperature_register() {
+    if (config_ & 0x01) {
+        if (one_shot_done_us_ >= 0 && sim::now_us() >= one_shot_done_us_) {
+            result_ = convert(one_shot_done_us_);
+            one_shot_done_us_ = -1;
+        }
+        return result_;
+    }
+
+    // Last conversion to finish before now
+    int64_t period = conversion_us();
+    return convert((sim::now_us() / period) * period);
+}
+
+uint16_t host::Tmp100Model::convert(int64_t finished) const {
+    int bits = 9 + ((config_ >> 5) & 0x3);
+    float lsb = 0.0625f * (1 << (12 - bits));
+    float celsius = std::fmax(-55.0f, std::fmin(125.0f, scene_(finished)));
+    int32_t counts = static_cast<int32_t>(std::floor(celsius / lsb)) * (1 << (12 - bits));
+    return static_cast<uint16_t>(counts * 16);
+}
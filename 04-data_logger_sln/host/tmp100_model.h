@@ -0,0 +1,72 @@
+#pragma once
+#include "sim/i2c.h"
+#include <cstdint>
+#include <functional>
+
+// Host model of a TI TMP100 on the simulated I2C bus.
+//
+// The pointer register selects temperature, configuration, T_LOW or T_HIGH.
+// Conversions run back to back (continuous mode) and the temperature register
+// holds the last finished one, taken from the scene at the time it finished and
+// rounded to the configured resolution. With SD set the sensor is shut down and
+// the register keeps its value; writing OS in shutdown runs a single conversion.
+namespace host {
+
+class Tmp100Model : public sim::I2cDeviceModel {
+public:
+    static constexpr int64_t CONVERSION_12BIT_US = 26000;     // Typical
+
+    // Temperature in Celsius at a virtual time (us)
+    using Scene = std::function<float(int64_t time_us)>;
+
+    explicit Tmp100Model(Scene scene);
+
+    bool on_start(bool read) override;
+    bool on_write(uint8_t byte) override;
+    uint8_t on_read() override;
+
+    uint64_t reads() const { return reads_; }
+    uint8_t config() const { return config_; }
+
+    // Single conversions started with OS
+    uint64_t one_shots() const { return one_shots_; }
+
+    // Temperature reads in shutdown while a one-shot was still running, which
+    // return the previous result
+    uint64_t stale_reads() const { return stale_reads_; }
+
+    // 12-bit conversion time of this part; lower resolutions scale with it
+    void set_conversion_time(int64_t conversion_12bit_us) {
+        conversion_12bit_us_ = conversion_12bit_us;
+    }
+
+private:
+    // Conversion time at the configured resolution
+    int64_t conversion_us() const;
+
+    // Temperature register contents, 12 bits left-justified
+    uint16_t temperature_register();
+
+    // The scene at a time, as the register would hold it
+    uint16_t convert(int64_t time_us) const;
+
+    // Configuration register write
+    void write_config(uint8_t config);
+
+    Scene scene_;
+    uint8_t pointer_ = 0;
+    uint8_t config_ = 0;
+    uint16_t t_low_ = 0x4B00;       // 75 C
+    uint16_t t_high_ = 0x5000;      // 80 C
+    int write_index_ = 0;           // Bytes written since START
+    int read_index_ = 0;            // Bytes read since START
+    uint16_t read_value_ = 0;       // Register latched for the current read
+    uint64_t reads_ = 0;
+    uint16_t result_ = 0;               // Register while shut down
+    int64_t one_shot_done_us_ = -1;     // End of the running one-shot conversion, -1 if none
+    uint64_t one_shots_ = 0;
+    uint64_t stale_reads_ = 0;
+    int64_t conversion_12bit_us_ = CONVERSION_12BIT_US;
+};
+
+} // namespace host
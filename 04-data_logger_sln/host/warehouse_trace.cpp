@@ -0,0 +1,88 @@
+#include "warehouse_trace.h"
+#include <cmath>
+
+namespace {
+
+constexpr uint32_t SAMPLE_PERIOD_S = 600;
+constexpr float PI = 3.14159265f;
+
+// Small deterministic generator so traces are identical on every host
+struct Random {
+    uint32_t state;
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Uniform in [0, 1)
+    float uniform() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+    // Roughly normal, sum of four uniforms
+    float noise(float sigma) {
+        float sum = uniform() + uniform() + uniform() + uniform() - 2.0f;
+        return sum * sigma * 1.732f;
+    }
+};
+
+float quantize(float celsius) {
+    return util::RecordEncoder::to_celsius(util::RecordEncoder::to_steps(celsius));
+}
+
+} // namespace
+
+const char* host::trace_name(Trace trace) {
+    switch (trace) {
+        case Trace::ColdRoom: return "cold_room";
+        case Trace::Ambient: return "ambient";
+        case Trace::DockDoor: return "dock_door";
+    }
+    return "unknown";
+}
+
+std::vector<util::Record> host::make_trace(Trace trace, size_t count, uint32_t seed, uint32_t start_s) {
+    Random random{seed != 0 ? seed : 1};
+    std::vector<util::Record> records;
+    records.reserve(count);
+
+    uint32_t timestamp_s = start_s;
+    float drift = 0.0f;
+    int door_open = 0;      // samples the dock door stays open
+    for (size_t i = 0; i < count; ++i) {
+        float hours = timestamp_s / 3600.0f;
+        float celsius = 0.0f;
+        switch (trace) {
+            case Trace::ColdRoom: {
+                // Triangle wave: the compressor pulls down, the room warms back up
+                float phase = std::fmod(timestamp_s / 3000.0f, 1.0f);
+                float triangle = phase < 0.5f ? phase * 4.0f - 1.0f : 3.0f - phase * 4.0f;
+                celsius = 3.0f + 0.8f * triangle + random.noise(0.05f);
+                break;
+            }
+            case Trace::Ambient:
+                drift += random.noise(0.02f);
+                celsius = 18.0f + 5.0f * std::sin(2.0f * PI * hours / 24.0f) + drift + random.noise(0.1f);
+                break;
+            case Trace::DockDoor:
+                if (door_open == 0 && random.uniform() < 0.05f) {
+                    door_open = 1 + static_cast<int>(random.uniform() * 3.0f);
+                }
+                celsius = 12.0f + 2.0f * std::sin(2.0f * PI * hours / 24.0f) + random.noise(0.1f);
+                if (door_open > 0) {
+                    celsius += 6.0f + 4.0f * random.uniform();
+                    door_open--;
+                }
+                break;
+        }
+        records.push_back({timestamp_s, quantize(celsius)});
+
+        // The dock loggers sometimes miss a sample (radio or brown-out resets)
+        timestamp_s += SAMPLE_PERIOD_S;
+        if (trace == Trace::DockDoor && random.uniform() < 0.01f) {
+            timestamp_s += SAMPLE_PERIOD_S;
+        }
+    }
+    return records;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "record_codec.h"
+#include <cstdint>
+#include <vector>
+
+// Synthetic temperature logs from the places loggers hang in a warehouse, one
+// reading every 10 minutes at the TMP100's 0.0625 C resolution.
+namespace host {
+
+enum class Trace {
+    ColdRoom,   // 3 C setpoint, compressor cycling +/-0.8 C every 50 minutes
+    Ambient,    // 18 C with a 10 C day/night swing and slow weather drift
+    DockDoor,   // 12 C, doors opening for 10-30 minutes (jumps of 6-10 C), missed samples
+};
+
+const char* trace_name(Trace trace);
+
+// count readings starting at start_s; the same seed gives the same trace
+std::vector<util::Record> make_trace(Trace trace, size_t count, uint32_t seed, uint32_t start_s = 0);
+
+} // namespace host
@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+// CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF). Pass the previous result as crc
+// to continue over several buffers.
+uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
+// CRC-32 as used by zlib and Ethernet (reflected poly 0xEDB88320). Start with 0
+// and pass the previous result to continue, like zlib's crc32().
+uint32_t crc32(const uint8_t* data, size_t len, uint32_t crc = 0);
+
+} // namespace util
@@ -0,0 +1,166 @@
+#pragma once
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "i2c_bus.h"
+#include "temperature_sensor.h"
+#include "eeprom_storage.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace app {
+
+inline void sleep_ms(int ms) { vTaskDelay(pdMS_TO_TICKS(ms)); }
+
+// Samples the TMP100 on a fixed period and logs each reading to the EEPROM.
+//
+// The sensor runs in one-shot mode at 12 bits: each cycle starts a conversion
+// (up to 48.75 ms) and reads the result. With overlap_store the reading of the previous
+// cycle is appended while the conversion runs, so when that append fills a page
+// the EEPROM write happens during the conversion instead of after it. The
+// newest reading then reaches the log one cycle later.
+class DataLoggerApp {
+public:
+    struct Config {
+        uint32_t sample_period_ms = 10 * 60 * 1000;    // Every 10 minutes
+        bool overlap_store = true;      // Store the previous reading during the conversion
+        bool verbose = true;            // Print the mount summary and a line per sample
+    };
+
+    // Time spent in step(), i.e. awake, per sample
+    struct CycleStats {
+        uint32_t cycles = 0;
+        int64_t total_awake_us = 0;
+        int64_t max_awake_us = 0;
+
+        float mean_awake_us() const {
+            return cycles > 0 ? static_cast<float>(total_awake_us) / cycles : 0.0f;
+        }
+    };
+
+    DataLoggerApp(driver::I2cBus& bus, driver::TemperatureSensor& sensor,
+                  driver::EepromStorage& storage, const Config& config)
+        : bus_(bus), sensor_(sensor), storage_(storage), config_(config) {}
+
+    // Mount the log and pick up the clock where the last stored record left it
+    // (the logger has no RTC, so timestamps count seconds of logging)
+    bool start() {
+        if (sensor_.set_resolution(driver::TemperatureSensor::Resolution::Bits12) !=
+            driver::TemperatureSensor::Status::Success) {
+            printf("Temperature sensor setup failed\n");
+        }
+        if (storage_.mount() != driver::EepromStorage::Status::Success) {
+            printf("Record log mount failed\n");
+            return false;
+        }
+        driver::EepromStorage::Record last;
+        if (storage_.end_index() > 0 &&
+            storage_.read_record(storage_.end_index() - 1, last) == driver::EepromStorage::Status::Success) {
+            next_timestamp_s_ = last.timestamp_s + config_.sample_period_ms / 1000;
+        }
+        ready_us_ = esp_timer_get_time();
+        if (!config_.verbose) {
+            return true;
+        }
+        printf("Record log: %u records stored (%u..%u), %u pages | ready %.1f ms after boot\n",
+               static_cast<unsigned>(storage_.end_index() - storage_.first_index()),
+               static_cast<unsigned>(storage_.first_index()), static_cast<unsigned>(storage_.end_index()),
+               static_cast<unsigned>(storage_.stored_pages()), ready_us_ / 1000.0f);
+        return true;
+    }
+
+    // Time from boot until start() had the log mounted, -1 before that.
+    // Counts every wake-up, so it is paid again on each power cycle.
+    int64_t boot_to_ready_us() const { return ready_us_; }
+
+    void run() {
+        if (!start()) {
+            return;
+        }
+        while (true) {
+            step();
+            sleep_ms(config_.sample_period_ms);
+        }
+    }
+
+    // One sample; returns false if the sensor could not be read or a record not stored
+    bool step() {
+        int64_t start_us = esp_timer_get_time();
+        uint32_t timestamp_s = next_timestamp_s_;
+        next_timestamp_s_ += config_.sample_period_ms / 1000;
+
+        bool ok = true;
+        driver::TemperatureSensor::Status status = sensor_.start_conversion();
+        if (config_.overlap_store) {
+            ok = store_held();
+        }
+        float celsius = 0.0f;
+        if (status == driver::TemperatureSensor::Status::Success) {
+            status = sensor_.read_result(celsius);
+        }
+        if (status == driver::TemperatureSensor::Status::Success) {
+            held_ = {timestamp_s, celsius};
+            has_held_ = true;
+            last_celsius_ = celsius;
+        } else {
+            printf("Temperature read failed (%d)\n", static_cast<int>(status));
+            ok = false;
+        }
+        if (!config_.overlap_store) {
+            ok = store_held() && ok;
+        }
+
+        int64_t awake_us = esp_timer_get_time() - start_us;
+        cycle_stats_.cycles++;
+        cycle_stats_.total_awake_us += awake_us;
+        cycle_stats_.max_awake_us = std::max(cycle_stats_.max_awake_us, awake_us);
+        if (ok && config_.verbose) {
+            print_diagnostics();
+        }
+        return ok;
+    }
+
+    // Append a reading step() is still holding (with overlap_store), e.g. before power-down
+    bool flush() { return store_held(); }
+
+    float last_celsius() const { return last_celsius_; }
+    const CycleStats& cycle_stats() const { return cycle_stats_; }
+
+private:
+    driver::I2cBus& bus_;
+    driver::TemperatureSensor& sensor_;
+    driver::EepromStorage& storage_;
+    Config config_;
+    float last_celsius_ = 0.0f;
+    uint32_t next_timestamp_s_ = 0;
+    int64_t ready_us_ = -1;
+    driver::EepromStorage::Record held_ = {};   // Read but not appended yet
+    bool has_held_ = false;
+    CycleStats cycle_stats_;
+
+    bool store_held() {
+        if (!has_held_) {
+            return true;
+        }
+        driver::EepromStorage::Status stored = storage_.append_record(held_);
+        if (stored != driver::EepromStorage::Status::Success) {
+            printf("Record append failed (%d)\n", static_cast<int>(stored));
+            return false;
+        }
+        has_held_ = false;
+        return true;
+    }
+
+    void print_diagnostics() {
+        driver::I2cBus::Stats stats = bus_.stats();
+        printf("Temperature:%.2f C | %u records logged (%u buffered) | awake %.1f ms mean | bus %.3f%% busy | queue %.0f us mean, %lld us max | %llu errors\n",
+               last_celsius_, static_cast<unsigned>(storage_.end_index()),
+               static_cast<unsigned>(storage_.pending_count() + (has_held_ ? 1 : 0)),
+               cycle_stats_.mean_awake_us() / 1000.0f,
+               stats.utilization() * 100.0f, stats.mean_queue_us(),
+               static_cast<long long>(stats.max_queue_us),
+               static_cast<unsigned long long>(stats.errors));
+    }
+};
+
+} // namespace app
@@ -0,0 +1,212 @@
+#pragma once
+#include "temperature_sensor.h"
+#include "eeprom_storage.h"
+#include "record_codec.h"
+#include "crc.h"
+#include "esp_timer.h"
+#include <cstdio>
+
+namespace app {
+
+// Readings kept across deep sleep. Lives in RTC slow memory (RTC_DATA_ATTR),
+// which keeps its contents while the chip sleeps but is not re-initialized by
+// constructors on wake-up, so this must stay plain data. crc covers every field
+// after it and is updated before each sleep, so a wake-up can tell intact
+// staging from garbage or from a write cut short by a reset.
+struct RtcStaging {
+    static constexpr uint32_t MAGIC = 0x4C4F4721;   // "LOG!"
+    // A page of 1-byte records, plus the reading that did not fit
+    static constexpr size_t MAX_RECORDS =
+        driver::EepromStorage::PAYLOAD_SIZE - util::RecordEncoder::BASE_SIZE + 2;
+
+    uint32_t magic;
+    uint32_t crc;                           // CRC-32 of the fields below
+    uint32_t next_timestamp_s;
+    uint32_t count;                         // Readings staged
+    uint32_t page_records;                  // How many of them fill one page
+    util::Record records[MAX_RECORDS];
+};
+
+// Deep-sleep operating mode: the chip is powered down between samples and each
+// wake-up runs wake() once from app_main, then sleeps again.
+//
+// A wake-up takes one reading (one-shot, 12 bits) and stages it in RTC memory.
+// Only once the staged readings fill a page does a wake-up mount the log and
+// write them to the EEPROM as one page, while the conversion runs. On all other
+// wake-ups the EEPROM is never addressed. With stage_in_rtc off, every reading
+// is written on the wake-up that took it, as it would be without RTC memory.
+//
+// Staged readings are lost with power, like the RAM buffer of DataLoggerApp, and
+// dropped whenever the staging fails its magic or CRC check.
+class DeepSleepLogger {
+public:
+    struct Config {
+        uint32_t sample_period_ms = 10 * 60 * 1000;    // Every 10 minutes
+        bool stage_in_rtc = true;
+    };
+
+    // Where one wake-up's time went, from wake() to its return
+    struct WakeReport {
+        int64_t awake_us = 0;
+        int64_t sensor_us = 0;      // Configure, start and read the conversion, including the wait
+        int64_t commit_us = 0;      // Mount, append and write to the EEPROM (overlaps the conversion)
+        uint32_t pages_written = 0;
+        bool staging_reset = false; // Staging was not valid and started over
+        bool ok = false;
+    };
+
+    DeepSleepLogger(RtcStaging& staging, driver::TemperatureSensor& sensor,
+                    driver::EepromStorage& storage, const Config& config)
+        : staging_(staging), sensor_(sensor), storage_(storage), config_(config) {}
+
+    // One wake-up's work. cold_boot: power-on or brownout reset, after which RTC
+    // memory holds no staging. After any other reset the staging is kept if it
+    // passes its magic and CRC check.
+    WakeReport wake(bool cold_boot) {
+        WakeReport report;
+        int64_t start_us = esp_timer_get_time();
+        report.ok = true;
+
+        if (cold_boot || !staging_valid()) {
+            report.staging_reset = true;
+            report.ok = resume(report);
+        }
+
+        int64_t sensor_start_us = esp_timer_get_time();
+        driver::TemperatureSensor::Status status =
+            sensor_.set_resolution(driver::TemperatureSensor::Resolution::Bits12);
+        if (status == driver::TemperatureSensor::Status::Success) {
+            status = sensor_.start_conversion();
+        }
+        int64_t sensor_busy_us = esp_timer_get_time() - sensor_start_us;
+
+        // A full page from the earlier wake-ups goes out while the sensor converts
+        if (staging_.count > staging_.page_records || (!config_.stage_in_rtc && staging_.count > 0)) {
+            report.ok = commit(report) && report.ok;
+        }
+
+        sensor_start_us = esp_timer_get_time();
+        float celsius = 0.0f;
+        if (status == driver::TemperatureSensor::Status::Success) {
+            status = sensor_.read_result(celsius);
+        }
+        uint32_t timestamp_s = staging_.next_timestamp_s;
+        staging_.next_timestamp_s += config_.sample_period_ms / 1000;
+        if (status == driver::TemperatureSensor::Status::Success) {
+            stage({timestamp_s, celsius});
+        } else {
+            printf("Temperature read failed (%d)\n", static_cast<int>(status));
+            report.ok = false;
+        }
+        report.sensor_us = sensor_busy_us + (esp_timer_get_time() - sensor_start_us);
+
+        // Without RTC memory the reading has to be in the EEPROM before sleeping
+        if (!config_.stage_in_rtc && staging_.count > 0) {
+            report.ok = commit(report) && report.ok;
+        }
+
+        staging_.crc = staging_crc();
+        report.awake_us = esp_timer_get_time() - start_us;
+        return report;
+    }
+
+    // Time to sleep so the next wake-up keeps the sample period (esp_timer counts from boot)
+    uint64_t sleep_us() const {
+        int64_t period_us = static_cast<int64_t>(config_.sample_period_ms) * 1000;
+        int64_t left_us = period_us - esp_timer_get_time();
+        return left_us > 0 ? static_cast<uint64_t>(left_us) : 0;
+    }
+
+private:
+    RtcStaging& staging_;
+    driver::TemperatureSensor& sensor_;
+    driver::EepromStorage& storage_;
+    Config config_;
+    bool mounted_ = false;
+
+    uint32_t staging_crc() const {
+        const uint8_t* begin = reinterpret_cast<const uint8_t*>(&staging_.next_timestamp_s);
+        const uint8_t* end = reinterpret_cast<const uint8_t*>(&staging_ + 1);
+        return util::crc32(begin, static_cast<size_t>(end - begin));
+    }
+
+    bool staging_valid() const {
+        return staging_.magic == RtcStaging::MAGIC && staging_.crc == staging_crc() &&
+               staging_.count <= RtcStaging::MAX_RECORDS && staging_.page_records <= staging_.count;
+    }
+
+    // After power-up: empty staging, timestamps continue from the newest stored record
+    bool resume(WakeReport& report) {
+        int64_t start_us = esp_timer_get_time();
+        staging_.magic = RtcStaging::MAGIC;
+        staging_.next_timestamp_s = 0;
+        staging_.count = 0;
+        staging_.page_records = 0;
+        bool ok = mount();
+        driver::EepromStorage::Record last;
+        if (ok && storage_.end_index() > 0 &&
+            storage_.read_record(storage_.end_index() - 1, last) == driver::EepromStorage::Status::Success) {
+            staging_.next_timestamp_s = last.timestamp_s + config_.sample_period_ms / 1000;
+        }
+        report.commit_us += esp_timer_get_time() - start_us;
+        return ok;
+    }
+
+    bool mount() {
+        if (!mounted_ && storage_.mount() != driver::EepromStorage::Status::Success) {
+            printf("Record log mount failed\n");
+            return false;
+        }
+        mounted_ = true;
+        return true;
+    }
+
+    void stage(const util::Record& record) {
+        if (staging_.count == RtcStaging::MAX_RECORDS) {
+            // Only if commits keep failing: drop the oldest rather than the newest
+            for (uint32_t i = 1; i < staging_.count; ++i) {
+                staging_.records[i - 1] = staging_.records[i];
+            }
+            staging_.count--;
+        }
+        staging_.records[staging_.count++] = record;
+        staging_.page_records = fitting_records();
+    }
+
+    // Leading staged readings that encode into one page
+    uint32_t fitting_records() const {
+        util::RecordEncoder encoder(driver::EepromStorage::PAYLOAD_SIZE);
+        uint32_t count = 0;
+        while (count < staging_.count && encoder.append(staging_.records[count])) {
+            count++;
+        }
+        return count;
+    }
+
+    // Append one page worth of staged readings and write it as one page
+    bool commit(WakeReport& report) {
+        int64_t start_us = esp_timer_get_time();
+        uint32_t count = config_.stage_in_rtc ? staging_.page_records : staging_.count;
+        bool ok = mount();
+        uint64_t pages_before = storage_.stats().pages_written;
+        for (uint32_t i = 0; ok && i < count; ++i) {
+            ok = storage_.append_record(staging_.records[i]) == driver::EepromStorage::Status::Success;
+        }
+        ok = ok && storage_.flush() == driver::EepromStorage::Status::Success;
+        report.pages_written += static_cast<uint32_t>(storage_.stats().pages_written - pages_before);
+
+        if (ok) {
+            for (uint32_t i = count; i < staging_.count; ++i) {
+                staging_.records[i - count] = staging_.records[i];
+            }
+            staging_.count -= count;
+            staging_.page_records = fitting_records();
+        } else {
+            printf("Record commit failed, %u readings stay staged\n", static_cast<unsigned>(staging_.count));
+        }
+        report.commit_us += esp_timer_get_time() - start_us;
+        return ok;
+    }
+};
+
+} // namespace app
@@ -0,0 +1,99 @@
+#pragma once
+#include "i2c_bus.h"
+#include "page_device.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <cstdint>
+
+namespace driver {
+
+// Microchip 24FC256: 32 KB in 512 pages of 64 bytes on a shared I2cBus.
+//
+// After a page write the part spends up to WRITE_CYCLE_US programming it and
+// NACKs its address meanwhile. How the driver waits for that is selectable:
+//
+//   AckPolling   write_page() probes the address until the part ACKs, so it
+//                returns soon after the page is programmed (typically well
+//                under the maximum). Probing starts POLL_START_US after the
+//                write and repeats every POLL_INTERVAL_US; each probe is its
+//                own transaction on the bus queue, so other devices' transfers
+//                run in between.
+//   FixedDelay   write_page() returns once the data is on the chip and the next
+//                access sleeps out the rest of WRITE_CYCLE_US, in whole ticks.
+class Eeprom : public PageDevice {
+public:
+    static constexpr uint16_t DEFAULT_ADDRESS = 0x50;       // A0-A2 low
+    static constexpr uint32_t SCL_SPEED_HZ = 1000000;       // Fast-mode Plus at 2.5 V and up
+    static constexpr size_t SIZE = 32768;
+    static constexpr size_t PAGE_SIZE = 64;
+    static constexpr size_t PAGE_COUNT = SIZE / PAGE_SIZE;
+    static constexpr int64_t WRITE_CYCLE_US = 5000;         // Datasheet maximum
+    static constexpr int64_t POLL_TIMEOUT_US = 2 * WRITE_CYCLE_US;
+    static constexpr uint32_t PROBE_SCL_HZ = 100000;        // i2c_master_probe() clocks at this, not SCL_SPEED_HZ
+    static constexpr int64_t POLL_START_US = 2500;          // First probe; no cycle is much shorter
+    static constexpr int64_t POLL_INTERVAL_US = 250;        // Between probe starts
+
+    enum class WriteWait {
+        AckPolling,
+        FixedDelay
+    };
+
+    // Page writes since construction
+    struct WriteStats {
+        uint64_t writes = 0;
+        uint64_t polls = 0;             // Probes sent, including the final ACKed one
+        int64_t total_write_us = 0;     // Time spent in write_page(), waits included
+        int64_t max_write_us = 0;
+        int64_t total_cycle_us = 0;     // End of transfer to first ACK (AckPolling only)
+        int64_t max_cycle_us = 0;
+
+        float mean_write_us() const {
+            return writes > 0 ? static_cast<float>(total_write_us) / writes : 0.0f;
+        }
+        float mean_cycle_us() const {
+            return writes > 0 ? static_cast<float>(total_cycle_us) / writes : 0.0f;
+        }
+    };
+
+    Eeprom(I2cBus& bus, uint16_t address = DEFAULT_ADDRESS, WriteWait wait = WriteWait::AckPolling);
+    ~Eeprom();
+
+    Eeprom(const Eeprom&) = delete;
+    Eeprom& operator=(const Eeprom&) = delete;
+
+    // Sequential read; wraps at the end of memory like the part itself
+    esp_err_t read(uint32_t address, uint8_t* data, size_t len) override;
+
+    // Program a full page. ESP_ERR_TIMEOUT if the part never came back (AckPolling).
+    esp_err_t write_page(uint32_t page, const uint8_t* data) override;
+
+    size_t page_size() const override { return PAGE_SIZE; }
+    size_t page_count() const override { return PAGE_COUNT; }
+
+    // False if the device could not be registered on the bus
+    bool is_ready() const { return device_ != nullptr; }
+
+    const WriteStats& write_stats() const { return write_stats_; }
+    void reset_write_stats() { write_stats_ = WriteStats(); }
+
+private:
+    I2cDevice* device_;
+    WriteWait wait_;
+    int64_t write_done_us_ = 0;     // End of the last write cycle (FixedDelay)
+    WriteStats write_stats_;
+    esp_timer_handle_t poll_timer_ = nullptr;
+    SemaphoreHandle_t poll_wake_ = nullptr;
+
+    // Sleep until the last write cycle has finished (FixedDelay)
+    void wait_write_cycle();
+
+    // Sleep until an esp_timer time, to the microsecond rather than the tick
+    void sleep_until(int64_t wake_us);
+    static void poll_handler(void* arg);
+
+    // Probe until the part ACKs again after a write that ended at written_us
+    esp_err_t poll_write_cycle(int64_t written_us);
+};
+
+} // namespace driver
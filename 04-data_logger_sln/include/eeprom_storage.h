@@ -0,0 +1,181 @@
+#pragma once
+#include "page_device.h"
+#include "record_codec.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace driver {
+
+// Where a bulk export stands, so it can resume after a reset or a failed upload
+struct ExportCursor {
+    uint32_t next_index = 0;    // First record not exported yet
+    uint32_t skipped = 0;       // Records overwritten or unreadable before they were exported
+};
+
+// Records handed out by one export step. crc32 covers the records in their
+// 8-byte wire form (see EepromStorage::record_crc32) so the receiver can check
+// them end to end.
+struct ExportChunk {
+    uint32_t first_index;
+    const util::Record* records;
+    size_t count;
+    uint32_t crc32;
+};
+
+// Destination of EepromStorage::export_records(), e.g. the uplink to the collector
+class RecordSink {
+public:
+    virtual ~RecordSink() = default;
+
+    // Take a chunk; false if it could not be delivered (the export stops there)
+    virtual bool write(const ExportChunk& chunk) = 0;
+};
+
+// Circular, log-structured record store on a PageDevice (the 24FC256).
+//
+// Records are compressed into a page buffer in RAM (see RecordEncoder). When the
+// next record no longer fits, the page is written in one go after the newest
+// one, wrapping around at the end of memory and overwriting the oldest page.
+// Every page is written once per lap, so wear is spread evenly over the whole
+// device, and a write cycle covers a page of readings (~44 on a steady
+// schedule) instead of one.
+//
+// Page layout (little-endian):
+//     0   uint32  sequence number, +1 for every page written
+//     4   uint32  index of the page's first record
+//     8   uint8   record count
+//     9   uint8   payload bytes used
+//     10  uint16  CRC-16 over the rest of the page
+//     12  payload, encoded records
+//
+// A page only becomes valid once its CRC matches, so a power cut loses the
+// records still buffered in RAM (less than a page) or, if it hits a page write,
+// the page being written; every other page stays readable.
+class EepromStorage {
+public:
+    enum class Status {
+        Success,
+        NotFound,       // Index older than the oldest stored record or not written yet
+        Corrupt,        // Page failed its CRC
+        BusError,       // The device did not answer
+        Stopped,        // The sink refused a chunk; resume from the cursor
+        Error           // Not mounted
+    };
+
+    using Record = util::Record;
+
+    static constexpr size_t PAGE_SIZE = 64;
+    static constexpr size_t HEADER_SIZE = 12;
+    static constexpr size_t PAYLOAD_SIZE = PAGE_SIZE - HEADER_SIZE;
+
+    // Pages fetched per sequential read during an export (on the stack)
+    static constexpr size_t EXPORT_BURST_PAGES = 8;
+
+    // Activity since mount()
+    struct Stats {
+        uint64_t pages_written = 0;
+        uint64_t pages_read = 0;        // Whole pages, CRC checked
+        uint64_t headers_read = 0;      // Header only, for searches
+        uint64_t records_appended = 0;
+        uint64_t records_evicted = 0;   // Overwritten when the log wrapped
+    };
+
+    explicit EepromStorage(PageDevice& device);
+
+    // Find the newest and oldest pages on the device with a binary search over
+    // page headers (about log2(pages) + 3 reads). Must succeed before any other
+    // call; an erased device mounts as an empty log.
+    Status mount();
+
+    // Buffer a record. If the page buffer is full it is written first; if that
+    // fails the record is not taken (BusError) and can be appended again later.
+    Status append_record(const Record& record);
+
+    // Record by index (0 = first record ever appended), from the device or the buffer
+    Status read_record(uint32_t index, Record& record);
+
+    // Write the buffered records now, as a partly filled page
+    Status flush();
+
+    // === Bulk export ===
+    // Decode up to capacity records from the cursor on straight into buffer and
+    // advance the cursor past them (keep a copy to retry). Pages come in bursts
+    // of EXPORT_BURST_PAGES with one sequential read each, instead of a read per
+    // record. Records the log overwrote since the cursor was saved are counted in
+    // cursor.skipped. chunk.count is 0 once the cursor reaches end_index().
+    Status read_records(ExportCursor& cursor, util::Record* buffer, size_t capacity, ExportChunk& chunk);
+
+    // Feed everything from the cursor on to a sink, capacity records per chunk.
+    // The cursor only moves past chunks the sink accepted.
+    Status export_records(ExportCursor& cursor, RecordSink& sink, util::Record* buffer, size_t capacity);
+
+    // Continue a CRC-32 over a record's wire form: uint32 timestamp, float bits (LE)
+    static uint32_t record_crc32(const Record& record, uint32_t crc);
+
+    // Index of the oldest record still stored, and one past the newest (buffered included)
+    uint32_t first_index() const { return first_index_; }
+    uint32_t end_index() const { return stored_end_ + encoder_.count(); }
+
+    // Records that have not reached the device yet
+    size_t pending_count() const { return encoder_.count(); }
+
+    // Pages of the device holding log data, out of page_count()
+    size_t stored_pages() const { return stored_pages_; }
+    size_t page_count() const { return device_.page_count(); }
+
+    // Page the next write goes to
+    uint32_t next_page() const { return next_sequence_ % device_.page_count(); }
+
+    const Stats& stats() const { return stats_; }
+
+private:
+    struct PageHeader {
+        uint32_t sequence;
+        uint32_t first_record;
+        uint8_t count;
+        uint8_t length;
+    };
+
+    PageDevice& device_;
+    bool mounted_ = false;
+
+    // The log is the stored_pages_ pages before next_sequence_; sequence number s
+    // always lives in page s % page_count(), so the log starts at page 0
+    size_t stored_pages_ = 0;
+    uint32_t next_sequence_ = 0;
+    uint32_t first_index_ = 0;      // First record of the tail page
+    uint32_t stored_end_ = 0;       // One past the last record on the device
+
+    util::RecordEncoder encoder_{PAYLOAD_SIZE};     // Records not written yet
+
+    // Last page read by read_record(), kept for sequential reads
+    uint32_t cached_page_ = UINT32_MAX;
+    uint8_t cache_[PAGE_SIZE] = {};
+
+    // Page the last export step stopped in, so the next one needs no search
+    uint32_t export_index_ = UINT32_MAX;
+    uint32_t export_page_ = 0;
+
+    Stats stats_;
+
+    // Read and check one page; Corrupt if the CRC does not match
+    Status load_page(uint32_t page, uint8_t* buffer, PageHeader& header);
+
+    // Read just the header of a page, unchecked
+    Status read_header(uint32_t page, PageHeader& header);
+
+    // Set up the log state once mount() found the oldest and newest page
+    Status finish_mount(bool found, const PageHeader& oldest, const PageHeader& newest);
+
+    // Write the page buffer after the newest page
+    Status write_pending();
+
+    // Page holding a stored record index
+    Status find_page(uint32_t index, uint32_t& page);
+
+    static void encode_header(const PageHeader& header, uint8_t* page);
+    static PageHeader decode_header(const uint8_t* page);
+    static uint16_t page_crc(const uint8_t* page);
+};
+
+} // namespace driver
@@ -0,0 +1,174 @@
+#pragma once
+#include "driver/i2c_master.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace driver {
+
+class I2cDevice;
+
+// One I2C transfer: an optional write followed by an optional read, with a
+// repeated START between them. A transaction with neither is an address probe.
+//
+// The caller owns the transaction and its buffers; they must stay alive until
+// I2cDevice::wait() returns for it.
+struct I2cTransaction {
+    I2cDevice* device = nullptr;
+    const uint8_t* write_data = nullptr;
+    size_t write_len = 0;
+    uint8_t* read_data = nullptr;
+    size_t read_len = 0;
+
+    // A write that only sets the device's register or address pointer. The bus
+    // may run it together with a read of the same device queued right behind it,
+    // as one write-read with a repeated START instead of two transfers.
+    bool mergeable = false;
+
+    // Filled in by the bus
+    esp_err_t result = ESP_OK;
+    std::atomic<bool> done{false};
+    TaskHandle_t waiter = nullptr;      // Task notified on completion
+    int64_t queued_us = 0;              // When the transaction was submitted
+};
+
+// Shares one I2C controller between several drivers. A single owner task runs
+// the queued transactions in order, so drivers on different tasks never need a
+// lock of their own and a slow EEPROM write never interleaves with a sensor read.
+//
+//     driver::I2cBus bus(driver::I2cBus::Config{});
+//     driver::I2cDevice* tmp100 = bus.add_device(0x48, 400000);
+//     driver::I2cDevice* eeprom = bus.add_device(0x50, 1000000);
+//
+// Each device has its own SCL speed; the controller switches per transfer.
+class I2cBus {
+public:
+    struct Config {
+        i2c_port_num_t port = I2C_NUM_0;
+        gpio_num_t sda_pin = GPIO_NUM_21;
+        gpio_num_t scl_pin = GPIO_NUM_22;
+        bool internal_pullup = true;    // Fine for short runs; add 4.7k resistors at 1 MHz
+        uint32_t queue_depth = 8;       // Transactions waiting for the owner task
+        UBaseType_t task_priority = 5;
+        int timeout_ms = 50;            // Per transfer, including clock stretching
+    };
+
+    // Bus activity since construction
+    struct Stats {
+        uint64_t transactions = 0;      // Completed, including failed ones
+        uint64_t merged = 0;            // Write-read pairs run as one transfer
+        uint64_t errors = 0;            // NACKs and timeouts (not NACKed probes)
+        int64_t busy_us = 0;            // Time spent inside i2c_master_* calls
+        int64_t elapsed_us = 0;         // Time since the bus was created
+        int64_t total_queue_us = 0;     // Sum of submit-to-start delays
+        int64_t max_queue_us = 0;       // Worst submit-to-start delay
+
+        // Fraction of the time the bus was transferring
+        float utilization() const {
+            return elapsed_us > 0 ? static_cast<float>(busy_us) / elapsed_us : 0.0f;
+        }
+
+        // Average time a transaction waited in the queue
+        float mean_queue_us() const {
+            return transactions > 0 ? static_cast<float>(total_queue_us) / transactions : 0.0f;
+        }
+    };
+
+    static constexpr size_t MAX_DEVICES = 8;
+
+    explicit I2cBus(const Config& config);
+    ~I2cBus();
+
+    // Devices and the owner task point back at the bus, so it must not be copied
+    I2cBus(const I2cBus&) = delete;
+    I2cBus& operator=(const I2cBus&) = delete;
+
+    // False if the controller or owner task could not be set up
+    bool is_ready() const;
+
+    // Register a 7-bit address at its own SCL speed. Returns nullptr if the bus is
+    // not ready, MAX_DEVICES are registered or the driver rejects the device.
+    // The bus owns the returned device.
+    I2cDevice* add_device(uint16_t address, uint32_t scl_speed_hz);
+
+    // Queue a transaction for the owner task. Returns ESP_ERR_TIMEOUT if the queue
+    // stays full for the bus timeout; the transaction is then not submitted.
+    esp_err_t submit(I2cTransaction& transaction);
+
+    // Snapshot of the statistics
+    Stats stats() const;
+
+    // Start counting from zero again
+    void reset_stats();
+
+    int timeout_ms() const { return config_.timeout_ms; }
+
+private:
+    Config config_;
+    i2c_master_bus_handle_t bus_handle_ = nullptr;
+    I2cDevice* devices_[MAX_DEVICES] = {};
+    size_t device_count_ = 0;
+
+    QueueHandle_t queue_ = nullptr;             // I2cTransaction* waiting to run
+    TaskHandle_t task_ = nullptr;               // Owner task
+    SemaphoreHandle_t task_stopped_ = nullptr;  // Given by the owner task on exit
+
+    mutable SemaphoreHandle_t stats_mutex_ = nullptr;
+    Stats stats_;
+    int64_t stats_start_us_ = 0;
+
+    // Run one transaction, or a mergeable write together with the read after it
+    void execute(I2cTransaction& first, I2cTransaction* second);
+
+    // Account for a transfer and wake its waiter(s)
+    void complete(I2cTransaction& transaction, esp_err_t result);
+
+    static void task_entry(void* arg);
+    void run();
+};
+
+// One device on an I2cBus. Blocking calls submit a transaction and sleep until
+// the owner task has run it; they use the calling task's notification value
+// (ulTaskNotifyTake), so don't mix them with other uses of it in the same task.
+class I2cDevice {
+public:
+    I2cDevice(I2cBus& bus, i2c_master_dev_handle_t handle, uint16_t address, uint32_t scl_speed_hz);
+    ~I2cDevice();
+
+    I2cDevice(const I2cDevice&) = delete;
+    I2cDevice& operator=(const I2cDevice&) = delete;
+
+    esp_err_t write(const uint8_t* data, size_t len);
+    esp_err_t read(uint8_t* data, size_t len);
+
+    // Write (e.g. a register pointer), repeated START, read
+    esp_err_t write_read(const uint8_t* write_data, size_t write_len, uint8_t* read_data, size_t read_len);
+
+    // ESP_OK if the device acknowledges its address, ESP_ERR_NOT_FOUND if not
+    esp_err_t probe();
+
+    // === Asynchronous use ===
+    // Queue a transaction for this device without waiting for it
+    esp_err_t submit(I2cTransaction& transaction);
+
+    // Sleep until a submitted transaction has run and return its result
+    esp_err_t wait(I2cTransaction& transaction);
+
+    uint16_t address() const { return address_; }
+    uint32_t scl_speed_hz() const { return scl_speed_hz_; }
+    i2c_master_dev_handle_t handle() const { return handle_; }
+
+private:
+    I2cBus& bus_;
+    i2c_master_dev_handle_t handle_;
+    uint16_t address_;
+    uint32_t scl_speed_hz_;
+
+    esp_err_t transfer(I2cTransaction& transaction);
+};
+
+} // namespace driver
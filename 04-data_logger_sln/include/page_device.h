@@ -0,0 +1,24 @@
+#pragma once
+#include "esp_err.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace driver {
+
+// Byte-readable, page-writable non-volatile memory. EepromStorage only talks to
+// this interface, so the same log runs on the 24FC256 or on a RAM-backed stand-in.
+class PageDevice {
+public:
+    virtual ~PageDevice() = default;
+
+    // Read len bytes starting at a byte address
+    virtual esp_err_t read(uint32_t address, uint8_t* data, size_t len) = 0;
+
+    // Program one whole page (page_size() bytes)
+    virtual esp_err_t write_page(uint32_t page, const uint8_t* data) = 0;
+
+    virtual size_t page_size() const = 0;
+    virtual size_t page_count() const = 0;
+};
+
+} // namespace driver
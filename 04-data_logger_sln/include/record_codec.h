@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace util {
+
+struct Record {
+    uint32_t timestamp_s;   // Seconds, as the application counts them
+    float celsius;
+};
+
+// Compact encoding for a page of temperature records.
+//
+// Readings come every sample period and move slowly, so after the first record
+// of a page only the changes are stored:
+//
+//     first record    uint32 timestamp, int16 temperature in 0.0625 C steps (LE)
+//     then per record
+//       0ttttttt      on schedule (same interval as the previous record) and the
+//                     temperature moved by zigzag(t) steps, |change| <= 4 C
+//       10000000      anything else, followed by two zigzag varints: the change in
+//                     interval (s) and the temperature change (steps)
+//
+// On a steady 10-minute schedule that is one byte per reading instead of eight.
+// Temperatures are stored at the TMP100's 12-bit resolution, so its readings
+// round-trip exactly; anything finer is rounded to the nearest 0.0625 C.
+// Each page decodes on its own, so pages stay randomly accessible.
+class RecordEncoder {
+public:
+    static constexpr size_t MAX_SIZE = 64;
+    static constexpr size_t BASE_SIZE = 6;          // First record of a page
+    static constexpr size_t MAX_RECORD_SIZE = 8;    // Escape byte + 5 + 2 varint bytes
+
+    // Encode into at most capacity bytes (<= MAX_SIZE)
+    explicit RecordEncoder(size_t capacity = MAX_SIZE);
+
+    // Add a record; false (and nothing changes) if it does not fit
+    bool append(const Record& record);
+
+    // Start an empty page
+    void clear();
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    size_t count() const { return count_; }
+
+    // Most records a page of capacity bytes can hold
+    static size_t max_records(size_t capacity);
+
+    // Celsius to the stored 0.0625 C steps and back
+    static int16_t to_steps(float celsius);
+    static float to_celsius(int16_t steps);
+
+private:
+    uint8_t data_[MAX_SIZE];
+    size_t capacity_;
+    size_t size_ = 0;
+    size_t count_ = 0;
+    uint32_t last_timestamp_s_ = 0;
+    uint32_t last_interval_s_ = 0;
+    int16_t last_steps_ = 0;
+};
+
+// Reads back the records of one page, in order
+class RecordDecoder {
+public:
+    RecordDecoder(const uint8_t* data, size_t size);
+
+    // Next record; false at the end of the data or if it is malformed (a tag the
+    // encoder never writes or a truncated varint), and on every call after that
+    bool next(Record& record);
+
+    // Skip count records; false if there are fewer
+    bool skip(size_t count);
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t position_ = 0;
+    bool started_ = false;
+    uint32_t last_timestamp_s_ = 0;
+    uint32_t last_interval_s_ = 0;
+    int16_t last_steps_ = 0;
+
+    bool read_varint(uint32_t& value);
+
+    // Give up on the rest of the data
+    bool malformed();
+};
+
+} // namespace util
@@ -0,0 +1,78 @@
+#pragma once
+#include "i2c_bus.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <cstdint>
+
+namespace driver {
+
+// TI TMP100 digital temperature sensor on a shared I2cBus.
+//
+// After power-up the sensor converts continuously and read_temperature() returns
+// the last finished conversion. For one-shot mode, start_conversion() shuts the
+// sensor down (SD) and triggers a single conversion (OS); read_result() fetches
+// it once conversion_time_us() has passed. The sensor sits in shutdown between
+// conversions, and the caller is free to use the bus while one runs.
+class TemperatureSensor {
+public:
+    enum class Status {
+        Success,        // Temperature read
+        BusError,       // The sensor did not answer or the transfer failed
+        Error           // Sensor not registered on the bus, or the conversion timer failed
+    };
+
+    // Conversion resolution; each extra bit doubles the conversion time
+    enum class Resolution : uint8_t {
+        Bits9 = 0,      // 0.5 C
+        Bits10 = 1,     // 0.25 C
+        Bits11 = 2,     // 0.125 C
+        Bits12 = 3      // 0.0625 C
+    };
+
+    static constexpr uint16_t DEFAULT_ADDRESS = 0x48;       // A0-A2 low
+    static constexpr uint32_t SCL_SPEED_HZ = 400000;        // Fast mode is the TMP100's limit
+
+    TemperatureSensor(I2cBus& bus, uint16_t address = DEFAULT_ADDRESS);
+    ~TemperatureSensor();
+
+    TemperatureSensor(const TemperatureSensor&) = delete;
+    TemperatureSensor& operator=(const TemperatureSensor&) = delete;
+
+    // Read the temperature register in degrees Celsius
+    Status read_temperature(float& celsius);
+
+    // Write the resolution bits of the configuration register
+    Status set_resolution(Resolution resolution);
+
+    // Start a single conversion and stay in shutdown afterwards
+    Status start_conversion();
+
+    // The conversion start_conversion() started, in degrees Celsius; sleeps
+    // until it has had its conversion time if called early
+    Status read_result(float& celsius);
+
+    // When the last started conversion is done (esp_timer time, us)
+    int64_t conversion_done_us() const { return conversion_done_us_; }
+
+    // Longest conversion time at a resolution, in us. Parts vary, and a read
+    // before a slow part finishes would return the previous result.
+    static uint32_t conversion_time_us(Resolution resolution);
+
+    // Convert the 2-byte temperature register (12 bits, left-justified) to Celsius
+    static float raw_to_celsius(uint8_t msb, uint8_t lsb);
+
+    uint16_t address() const { return address_; }
+
+private:
+    I2cDevice* device_;
+    uint16_t address_;
+    uint8_t config_ = 0;    // Last value written to the configuration register
+    int64_t conversion_done_us_ = 0;
+    esp_timer_handle_t conversion_timer_ = nullptr;
+    SemaphoreHandle_t conversion_done_ = nullptr;
+
+    static void conversion_handler(void* arg);
+};
+
+} // namespace driver
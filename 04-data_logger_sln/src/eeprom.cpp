@@ -0,0 +1,127 @@
+#include "eeprom.h"
+#include "freertos/task.h"
+#include <algorithm>
+#include <cstring>
+
+driver::Eeprom::Eeprom(I2cBus& bus, uint16_t address, WriteWait wait)
+    : device_(bus.add_device(address, SCL_SPEED_HZ)), wait_(wait)
+{
+    // Wakes the writer for its next probe without rounding up to a tick
+    poll_wake_ = xSemaphoreCreateBinary();
+    esp_timer_create_args_t args = {};
+    args.callback = &Eeprom::poll_handler;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "eeprom_poll";
+    if (poll_wake_ == nullptr || esp_timer_create(&args, &poll_timer_) != ESP_OK) {
+        poll_timer_ = nullptr;
+    }
+}
+
+driver::Eeprom::~Eeprom() {
+    if (poll_timer_ != nullptr) {
+        esp_timer_stop(poll_timer_);
+        esp_timer_delete(poll_timer_);
+    }
+    if (poll_wake_ != nullptr) {
+        vSemaphoreDelete(poll_wake_);
+    }
+}
+
+esp_err_t driver::Eeprom::read(uint32_t address, uint8_t* data, size_t len) {
+    if (device_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (address >= SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    wait_write_cycle();
+    uint8_t pointer[2] = {static_cast<uint8_t>(address >> 8), static_cast<uint8_t>(address & 0xFF)};
+    return device_->write_read(pointer, sizeof(pointer), data, len);
+}
+
+esp_err_t driver::Eeprom::write_page(uint32_t page, const uint8_t* data) {
+    if (device_ == nullptr) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (page >= PAGE_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t start_us = esp_timer_get_time();
+    wait_write_cycle();
+    uint32_t address = page * PAGE_SIZE;
+    uint8_t frame[2 + PAGE_SIZE];
+    frame[0] = static_cast<uint8_t>(address >> 8);
+    frame[1] = static_cast<uint8_t>(address & 0xFF);
+    memcpy(frame + 2, data, PAGE_SIZE);
+
+    esp_err_t err = device_->write(frame, sizeof(frame));
+    int64_t written_us = esp_timer_get_time();
+    if (err == ESP_OK) {
+        if (wait_ == WriteWait::AckPolling) {
+            err = poll_write_cycle(written_us);
+        } else {
+            write_done_us_ = written_us + WRITE_CYCLE_US;
+        }
+    }
+
+    int64_t write_us = esp_timer_get_time() - start_us;
+    write_stats_.writes++;
+    write_stats_.total_write_us += write_us;
+    write_stats_.max_write_us = std::max(write_stats_.max_write_us, write_us);
+    return err;
+}
+
+void driver::Eeprom::wait_write_cycle() {
+    // Sleeps in whole ticks, so up to 10 ms at 100 Hz for the 5 ms cycle
+    while (esp_timer_get_time() < write_done_us_) {
+        vTaskDelay(1);
+    }
+}
+
+void driver::Eeprom::sleep_until(int64_t wake_us) {
+    int64_t delay_us = wake_us - esp_timer_get_time();
+    if (delay_us <= 0) {
+        return;
+    }
+    if (poll_timer_ != nullptr) {
+        xSemaphoreTake(poll_wake_, 0);     // drop a wake-up left from a timed-out wait
+        esp_timer_start_once(poll_timer_, static_cast<uint64_t>(delay_us));
+        xSemaphoreTake(poll_wake_, portMAX_DELAY);
+    }
+    while (esp_timer_get_time() < wake_us) {
+        vTaskDelay(1);
+    }
+}
+
+void driver::Eeprom::poll_handler(void* arg) {
+    auto* eeprom = static_cast<Eeprom*>(arg);
+    xSemaphoreGive(eeprom->poll_wake_);
+}
+
+esp_err_t driver::Eeprom::poll_write_cycle(int64_t written_us) {
+    // A probe runs at PROBE_SCL_HZ (100 kHz) whatever SCL_SPEED_HZ says and holds
+    // the bus for about 110 us. Probing back to back from the end of the write
+    // would fill the bus with NACKs for the whole cycle, so the first probe waits
+    // until a fast part could be done and the rest are spaced POLL_INTERVAL_US
+    // apart. The caller sleeps in between, so the CPU and the bus can idle.
+    int64_t probe_us = written_us + POLL_START_US;
+    while (true) {
+        sleep_until(probe_us);
+        probe_us += POLL_INTERVAL_US;
+        esp_err_t err = device_->probe();
+        write_stats_.polls++;
+        int64_t now_us = esp_timer_get_time();
+        if (err == ESP_OK) {
+            int64_t cycle_us = now_us - written_us;
+            write_stats_.total_cycle_us += cycle_us;
+            write_stats_.max_cycle_us = std::max(write_stats_.max_cycle_us, cycle_us);
+            return ESP_OK;
+        }
+        if (now_us - written_us > POLL_TIMEOUT_US) {
+            return ESP_ERR_TIMEOUT;
+        }
+    }
+}
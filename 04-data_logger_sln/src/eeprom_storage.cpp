@@ -0,0 +1,441 @@
+#include "eeprom_storage.h"
+#include "crc.h"
+#include <cstring>
+
+// Erased EEPROM reads as 0xFF
+static constexpr uint8_t ERASED = 0xFF;
+
+static void put_u32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+}
+
+static uint32_t get_u32(const uint8_t* in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+driver::EepromStorage::EepromStorage(PageDevice& device)
+    : device_(device)
+{
+}
+
+driver::EepromStorage::Status driver::EepromStorage::mount() {
+    mounted_ = false;
+    if (device_.page_size() != PAGE_SIZE) {
+        return Status::Error;
+    }
+    encoder_.clear();
+    cached_page_ = UINT32_MAX;
+    export_index_ = UINT32_MAX;
+    stats_ = Stats();
+
+    // Sequence number s always lives in page s % pages and the log starts at
+    // page 0, so sequence - page is the lap count times pages: the same for every
+    // page of the current lap up to the newest page, one lap less after it. That
+    // makes the newest page a binary search over headers instead of a full scan.
+    uint32_t pages = device_.page_count();
+    uint8_t buffer[PAGE_SIZE];
+    PageHeader header;
+    Status status = load_page(0, buffer, header);
+    if (status == Status::BusError) {
+        return status;
+    }
+
+    uint32_t head = 0;
+    PageHeader first_page = header;
+    PageHeader newest = {};
+    if (status != Status::Success || header.sequence % pages != 0) {
+        // Page 0 is erased, or was torn while the log wrapped onto it; then the
+        // newest page is the last one
+        status = load_page(pages - 1, buffer, header);
+        if (status == Status::BusError) {
+            return status;
+        }
+        if (status != Status::Success || header.sequence % pages != pages - 1) {
+            return finish_mount(false, header, header);
+        }
+        head = pages - 1;
+        newest = header;
+    } else {
+        uint32_t lap_start = header.sequence;
+        uint32_t low = 0;
+        uint32_t high = pages - 1;
+        while (low < high) {
+            uint32_t mid = (low + high + 1) / 2;
+            status = read_header(mid, header);
+            if (status != Status::Success) {
+                return status;
+            }
+            if (header.sequence - mid == lap_start) {
+                low = mid;
+            } else {
+                high = mid - 1;
+            }
+        }
+
+        // The header looked right; a torn write can still have left a bad payload,
+        // in which case the page before it is the newest complete one
+        head = low;
+        status = load_page(head, buffer, newest);
+        if (status == Status::BusError) {
+            return status;
+        }
+        if (status != Status::Success) {
+            if (head == 0) {
+                return finish_mount(false, header, header);
+            }
+            head--;
+            status = load_page(head, buffer, newest);
+            if (status != Status::Success) {
+                return status == Status::BusError ? status : Status::Corrupt;
+            }
+        }
+    }
+
+    // Until the newest page reaches the end of the device the log starts at page
+    // 0. After that the page after the newest is the oldest, unless a torn write
+    // took it out.
+    PageHeader oldest = first_page;
+    if (newest.sequence + 1 >= pages) {
+        status = load_page((head + 1) % pages, buffer, oldest);
+        if (status == Status::Success && oldest.sequence != newest.sequence + 1 - pages) {
+            status = Status::Corrupt;
+        }
+        if (status == Status::Corrupt) {
+            status = load_page((head + 2) % pages, buffer, oldest);
+        }
+    }
+    if (status != Status::Success) {
+        return status;
+    }
+    return finish_mount(true, oldest, newest);
+}
+
+driver::EepromStorage::Status driver::EepromStorage::finish_mount(bool found, const PageHeader& oldest,
+                                                                  const PageHeader& newest) {
+    if (!found) {
+        next_sequence_ = 0;
+        stored_pages_ = 0;
+        first_index_ = 0;
+        stored_end_ = 0;
+    } else {
+        next_sequence_ = newest.sequence + 1;
+        stored_pages_ = newest.sequence - oldest.sequence + 1;
+        first_index_ = oldest.first_record;
+        stored_end_ = newest.first_record + newest.count;
+    }
+    mounted_ = true;
+    return Status::Success;
+}
+
+driver::EepromStorage::Status driver::EepromStorage::append_record(const Record& record) {
+    if (!mounted_) {
+        return Status::Error;
+    }
+
+    if (!encoder_.append(record)) {
+        // Page full: write it out and start the next one with this record
+        Status status = write_pending();
+        if (status != Status::Success) {
+            return status;
+        }
+        encoder_.append(record);
+    }
+    stats_.records_appended++;
+    return Status::Success;
+}
+
+driver::EepromStorage::Status driver::EepromStorage::flush() {
+    if (!mounted_) {
+        return Status::Error;
+    }
+    return encoder_.count() > 0 ? write_pending() : Status::Success;
+}
+
+driver::EepromStorage::Status driver::EepromStorage::read_record(uint32_t index, Record& record) {
+    if (!mounted_) {
+        return Status::Error;
+    }
+    if (index < first_index_ || index >= end_index()) {
+        return Status::NotFound;
+    }
+    if (index >= stored_end_) {
+        util::RecordDecoder pending(encoder_.data(), encoder_.size());
+        return pending.skip(index - stored_end_) && pending.next(record) ? Status::Success : Status::Corrupt;
+    }
+
+    uint32_t page = 0;
+    Status status = find_page(index, page);
+    if (status != Status::Success) {
+        return status;
+    }
+
+    PageHeader header = decode_header(cache_);
+    if (cached_page_ != page) {
+        status = load_page(page, cache_, header);
+        if (status != Status::Success) {
+            cached_page_ = UINT32_MAX;
+            return status;
+        }
+        cached_page_ = page;
+    }
+
+    // Pages decode from their own base record, so only this page is needed
+    util::RecordDecoder decoder(cache_ + HEADER_SIZE, header.length);
+    if (!decoder.skip(index - header.first_record) || !decoder.next(record)) {
+        return Status::Corrupt;
+    }
+    return Status::Success;
+}
+
+driver::EepromStorage::Status driver::EepromStorage::read_records(ExportCursor& cursor, Record* buffer,
+                                                                  size_t capacity, ExportChunk& chunk) {
+    if (!mounted_) {
+        return Status::Error;
+    }
+    if (cursor.next_index < first_index_) {
+        cursor.skipped += first_index_ - cursor.next_index;
+        cursor.next_index = first_index_;
+    }
+
+    uint32_t index = cursor.next_index;
+    size_t count = 0;
+    uint32_t crc = 0;
+
+    if (index < stored_end_ && capacity > 0) {
+        uint32_t pages = device_.page_count();
+        uint32_t newest = (next_sequence_ - 1) % pages;
+        uint32_t page = export_page_;
+        if (index != export_index_) {
+            Status status = find_page(index, page);
+            if (status != Status::Success) {
+                return status;
+            }
+        }
+
+        uint8_t burst[EXPORT_BURST_PAGES * PAGE_SIZE];
+        uint32_t last_page = page;
+        uint32_t left = (newest + pages - page) % pages + 1;     // pages up to the newest
+        while (count < capacity && index < stored_end_ && left > 0) {
+            // One sequential read for the next pages of the log, stopping at the
+            // newest page and at the end of the device
+            uint32_t burst_pages = EXPORT_BURST_PAGES;
+            burst_pages = left < burst_pages ? left : burst_pages;
+            burst_pages = pages - page < burst_pages ? pages - page : burst_pages;
+            if (device_.read(page * PAGE_SIZE, burst, burst_pages * PAGE_SIZE) != ESP_OK) {
+                return Status::BusError;
+            }
+            stats_.pages_read += burst_pages;
+
+            for (uint32_t i = 0; i < burst_pages && count < capacity; ++i) {
+                const uint8_t* data = burst + i * PAGE_SIZE;
+                uint16_t stored_crc = data[10] | (data[11] << 8);
+                PageHeader header = decode_header(data);
+                if (stored_crc != page_crc(data) || header.length > PAYLOAD_SIZE) {
+                    continue;   // its records are counted as skipped by the next good page
+                }
+                if (header.first_record > index) {
+                    cursor.skipped += header.first_record - index;
+                    index = header.first_record;
+                }
+
+                util::RecordDecoder decoder(data + HEADER_SIZE, header.length);
+                if (!decoder.skip(index - header.first_record)) {
+                    continue;
+                }
+                while (count < capacity && decoder.next(buffer[count])) {
+                    crc = record_crc32(buffer[count], crc);
+                    count++;
+                    index++;
+                }
+                // Resume in the next page once this one is used up
+                last_page = (page + i + (count < capacity ? 1 : 0)) % pages;
+            }
+            page = (page + burst_pages) % pages;
+            left -= burst_pages;
+        }
+
+        // Records after a bad newest page are gone too
+        if (index < stored_end_ && count < capacity) {
+            cursor.skipped += stored_end_ - index;
+            index = stored_end_;
+        }
+        export_index_ = index;
+        export_page_ = last_page;
+    }
+
+    // Then whatever is still buffered in RAM
+    if (count < capacity && index >= stored_end_ && index < end_index()) {
+        util::RecordDecoder pending(encoder_.data(), encoder_.size());
+        pending.skip(index - stored_end_);
+        while (count < capacity && pending.next(buffer[count])) {
+            crc = record_crc32(buffer[count], crc);
+            count++;
+            index++;
+        }
+    }
+
+    chunk.first_index = cursor.next_index;
+    chunk.records = buffer;
+    chunk.count = count;
+    chunk.crc32 = crc;
+    cursor.next_index = index;
+    return Status::Success;
+}
+
+driver::EepromStorage::Status driver::EepromStorage::export_records(ExportCursor& cursor, RecordSink& sink,
+                                                                    Record* buffer, size_t capacity) {
+    while (true) {
+        ExportCursor next = cursor;
+        ExportChunk chunk;
+        Status status = read_records(next, buffer, capacity, chunk);
+        if (status != Status::Success) {
+            return status;
+        }
+        if (chunk.count == 0) {
+            cursor = next;
+            return Status::Success;
+        }
+        if (!sink.write(chunk)) {
+            return Status::Stopped;
+        }
+        cursor = next;
+    }
+}
+
+uint32_t driver::EepromStorage::record_crc32(const Record& record, uint32_t crc) {
+    uint8_t wire[8];
+    uint32_t bits;
+    memcpy(&bits, &record.celsius, sizeof(bits));
+    put_u32(wire, record.timestamp_s);
+    put_u32(wire + 4, bits);
+    return util::crc32(wire, sizeof(wire), crc);
+}
+
+driver::EepromStorage::Status driver::EepromStorage::write_pending() {
+    uint32_t pages = device_.page_count();
+    uint32_t page = next_sequence_ % pages;
+
+    PageHeader header;
+    header.sequence = next_sequence_;
+    header.first_record = stored_end_;
+    header.count = static_cast<uint8_t>(encoder_.count());
+    header.length = static_cast<uint8_t>(encoder_.size());
+
+    uint8_t buffer[PAGE_SIZE];
+    memset(buffer, ERASED, sizeof(buffer));
+    memcpy(buffer + HEADER_SIZE, encoder_.data(), encoder_.size());
+    encode_header(header, buffer);
+
+    if (page == cached_page_) {
+        cached_page_ = UINT32_MAX;
+    }
+    if (page == export_page_) {
+        export_index_ = UINT32_MAX;
+    }
+    if (device_.write_page(page, buffer) != ESP_OK) {
+        return Status::BusError;
+    }
+    stats_.pages_written++;
+    next_sequence_++;
+    stored_end_ += encoder_.count();
+    encoder_.clear();
+
+    if (stored_pages_ < pages) {
+        stored_pages_++;
+        return Status::Success;
+    }
+
+    // The log wrapped over its oldest page; the next one is now the oldest
+    PageHeader oldest;
+    if (read_header((page + 1) % pages, oldest) != Status::Success) {
+        return Status::BusError;
+    }
+    uint32_t first = oldest.first_record;
+    stats_.records_evicted += first - first_index_;
+    first_index_ = first;
+    return Status::Success;
+}
+
+driver::EepromStorage::Status driver::EepromStorage::find_page(uint32_t index, uint32_t& page) {
+    uint32_t pages = device_.page_count();
+    if (cached_page_ != UINT32_MAX) {
+        PageHeader header = decode_header(cache_);
+        if (index >= header.first_record && index < header.first_record + header.count) {
+            page = cached_page_;
+            return Status::Success;
+        }
+    }
+
+    // Binary search for the last page whose first record is <= index, in log order
+    uint32_t oldest_sequence = next_sequence_ - stored_pages_;
+    uint32_t low = 0;
+    uint32_t high = stored_pages_ - 1;
+    while (low < high) {
+        uint32_t mid = (low + high + 1) / 2;
+        PageHeader header;
+        if (read_header((oldest_sequence + mid) % pages, header) != Status::Success) {
+            return Status::BusError;
+        }
+        if (header.first_record <= index) {
+            low = mid;
+        } else {
+            high = mid - 1;
+        }
+    }
+    page = (oldest_sequence + low) % pages;
+    return Status::Success;
+}
+
+driver::EepromStorage::Status driver::EepromStorage::load_page(uint32_t page, uint8_t* buffer,
+                                                               PageHeader& header) {
+    if (device_.read(page * PAGE_SIZE, buffer, PAGE_SIZE) != ESP_OK) {
+        return Status::BusError;
+    }
+    stats_.pages_read++;
+
+    uint16_t stored_crc = buffer[10] | (buffer[11] << 8);
+    header = decode_header(buffer);
+    if (stored_crc != page_crc(buffer) || header.count == 0 ||
+        header.count > util::RecordEncoder::max_records(PAYLOAD_SIZE) || header.length > PAYLOAD_SIZE) {
+        return Status::Corrupt;
+    }
+    return Status::Success;
+}
+
+driver::EepromStorage::Status driver::EepromStorage::read_header(uint32_t page, PageHeader& header) {
+    uint8_t raw[HEADER_SIZE];
+    if (device_.read(page * PAGE_SIZE, raw, sizeof(raw)) != ESP_OK) {
+        return Status::BusError;
+    }
+    stats_.headers_read++;
+    header = decode_header(raw);
+    return Status::Success;
+}
+
+void driver::EepromStorage::encode_header(const PageHeader& header, uint8_t* page) {
+    put_u32(page, header.sequence);
+    put_u32(page + 4, header.first_record);
+    page[8] = header.count;
+    page[9] = header.length;
+    uint16_t crc = page_crc(page);
+    page[10] = crc & 0xFF;
+    page[11] = crc >> 8;
+}
+
+driver::EepromStorage::PageHeader driver::EepromStorage::decode_header(const uint8_t* page) {
+    PageHeader header;
+    header.sequence = get_u32(page);
+    header.first_record = get_u32(page + 4);
+    header.count = page[8];
+    header.length = page[9];
+    return header;
+}
+
+uint16_t driver::EepromStorage::page_crc(const uint8_t* page) {
+    // Everything but the CRC field itself
+    uint16_t crc = util::crc16(page, 10);
+    return util::crc16(page + HEADER_SIZE, PAYLOAD_SIZE, crc);
+}
@@ -0,0 +1,261 @@
+#include "i2c_bus.h"
+#include "esp_timer.h"
+#include <algorithm>
+
+// === I2cBus ===
+
+driver::I2cBus::I2cBus(const Config& config)
+    : config_(config)
+{
+    i2c_master_bus_config_t bus_config = {};
+    bus_config.i2c_port = config.port;
+    bus_config.sda_io_num = config.sda_pin;
+    bus_config.scl_io_num = config.scl_pin;
+    bus_config.clk_source = I2C_CLK_SRC_DEFAULT;
+    bus_config.glitch_ignore_cnt = 7;
+    bus_config.flags.enable_internal_pullup = config.internal_pullup;
+    // trans_queue_depth stays 0: the owner task is the queue, the driver runs synchronously
+    if (i2c_new_master_bus(&bus_config, &bus_handle_) != ESP_OK) {
+        bus_handle_ = nullptr;
+        return;
+    }
+
+    queue_ = xQueueCreate(config.queue_depth, sizeof(I2cTransaction*));
+    task_stopped_ = xSemaphoreCreateBinary();
+    stats_mutex_ = xSemaphoreCreateMutex();
+    stats_start_us_ = esp_timer_get_time();
+    if (queue_ == nullptr || task_stopped_ == nullptr || stats_mutex_ == nullptr ||
+        xTaskCreate(task_entry, "i2c_bus", 3072, this, config.task_priority, &task_) != pdPASS) {
+        task_ = nullptr;
+    }
+}
+
+driver::I2cBus::~I2cBus() {
+    // A null transaction tells the owner task to finish
+    if (task_ != nullptr) {
+        I2cTransaction* stop = nullptr;
+        xQueueSend(queue_, &stop, portMAX_DELAY);
+        xSemaphoreTake(task_stopped_, portMAX_DELAY);
+    }
+    for (size_t i = 0; i < device_count_; ++i) {
+        delete devices_[i];
+    }
+    if (bus_handle_ != nullptr) {
+        i2c_del_master_bus(bus_handle_);
+    }
+    if (queue_ != nullptr) {
+        vQueueDelete(queue_);
+    }
+    if (task_stopped_ != nullptr) {
+        vSemaphoreDelete(task_stopped_);
+    }
+    if (stats_mutex_ != nullptr) {
+        vSemaphoreDelete(stats_mutex_);
+    }
+}
+
+bool driver::I2cBus::is_ready() const {
+    return task_ != nullptr;
+}
+
+driver::I2cDevice* driver::I2cBus::add_device(uint16_t address, uint32_t scl_speed_hz) {
+    if (!is_ready() || device_count_ >= MAX_DEVICES) {
+        return nullptr;
+    }
+
+    i2c_device_config_t dev_config = {};
+    dev_config.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+    dev_config.device_address = address;
+    dev_config.scl_speed_hz = scl_speed_hz;
+    i2c_master_dev_handle_t handle = nullptr;
+    if (i2c_master_bus_add_device(bus_handle_, &dev_config, &handle) != ESP_OK) {
+        return nullptr;
+    }
+
+    I2cDevice* device = new I2cDevice(*this, handle, address, scl_speed_hz);
+    devices_[device_count_++] = device;
+    return device;
+}
+
+esp_err_t driver::I2cBus::submit(I2cTransaction& transaction) {
+    if (!is_ready()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    transaction.result = ESP_OK;
+    transaction.done = false;
+    transaction.waiter = xTaskGetCurrentTaskHandle();
+    transaction.queued_us = esp_timer_get_time();
+
+    I2cTransaction* item = &transaction;
+    if (xQueueSend(queue_, &item, pdMS_TO_TICKS(config_.timeout_ms)) != pdPASS) {
+        return ESP_ERR_TIMEOUT;
+    }
+    return ESP_OK;
+}
+
+driver::I2cBus::Stats driver::I2cBus::stats() const {
+    xSemaphoreTake(stats_mutex_, portMAX_DELAY);
+    Stats snapshot = stats_;
+    snapshot.elapsed_us = esp_timer_get_time() - stats_start_us_;
+    xSemaphoreGive(stats_mutex_);
+    return snapshot;
+}
+
+void driver::I2cBus::reset_stats() {
+    xSemaphoreTake(stats_mutex_, portMAX_DELAY);
+    stats_ = Stats();
+    stats_start_us_ = esp_timer_get_time();
+    xSemaphoreGive(stats_mutex_);
+}
+
+void driver::I2cBus::task_entry(void* arg) {
+    static_cast<I2cBus*>(arg)->run();
+}
+
+void driver::I2cBus::run() {
+    I2cTransaction* transaction = nullptr;
+    while (true) {
+        xQueueReceive(queue_, &transaction, portMAX_DELAY);
+        if (transaction == nullptr) {
+            break;
+        }
+
+        // A pointer write followed by a read of the same device becomes one
+        // write-read: the read starts with a repeated START instead of a new
+        // START after a STOP, and saves a round trip through the queue
+        I2cTransaction* next = nullptr;
+        if (transaction->mergeable && transaction->read_len == 0 &&
+            xQueuePeek(queue_, &next, 0) == pdPASS && next != nullptr &&
+            next->device == transaction->device && next->write_len == 0 && next->read_len > 0) {
+            xQueueReceive(queue_, &next, 0);
+            execute(*transaction, next);
+        } else {
+            execute(*transaction, nullptr);
+        }
+    }
+
+    xSemaphoreGive(task_stopped_);
+    vTaskDelete(nullptr);
+}
+
+void driver::I2cBus::execute(I2cTransaction& first, I2cTransaction* second) {
+    int64_t start_us = esp_timer_get_time();
+    i2c_master_dev_handle_t handle = first.device->handle();
+
+    esp_err_t err;
+    if (second != nullptr) {
+        err = i2c_master_transmit_receive(handle, first.write_data, first.write_len,
+                                          second->read_data, second->read_len, config_.timeout_ms);
+    } else if (first.write_len > 0 && first.read_len > 0) {
+        err = i2c_master_transmit_receive(handle, first.write_data, first.write_len,
+                                          first.read_data, first.read_len, config_.timeout_ms);
+    } else if (first.write_len > 0) {
+        err = i2c_master_transmit(handle, first.write_data, first.write_len, config_.timeout_ms);
+    } else if (first.read_len > 0) {
+        err = i2c_master_receive(handle, first.read_data, first.read_len, config_.timeout_ms);
+    } else {
+        err = i2c_master_probe(bus_handle_, first.device->address(), config_.timeout_ms);
+    }
+    int64_t end_us = esp_timer_get_time();
+    // A NACKed probe is an answer (e.g. an EEPROM still in its write cycle), not a bus error
+    bool failed = err != ESP_OK &&
+                  !(second == nullptr && first.write_len == 0 && first.read_len == 0 && err == ESP_ERR_NOT_FOUND);
+
+    xSemaphoreTake(stats_mutex_, portMAX_DELAY);
+    stats_.busy_us += end_us - start_us;
+    for (I2cTransaction* transaction : {&first, second}) {
+        if (transaction == nullptr) {
+            continue;
+        }
+        int64_t queue_us = start_us - transaction->queued_us;
+        stats_.transactions++;
+        stats_.total_queue_us += queue_us;
+        stats_.max_queue_us = std::max(stats_.max_queue_us, queue_us);
+        if (failed) {
+            stats_.errors++;
+        }
+    }
+    if (second != nullptr) {
+        stats_.merged++;
+    }
+    xSemaphoreGive(stats_mutex_);
+
+    complete(first, err);
+    if (second != nullptr) {
+        complete(*second, err);
+    }
+}
+
+void driver::I2cBus::complete(I2cTransaction& transaction, esp_err_t result) {
+    // The waiter may reuse the transaction as soon as done is set
+    TaskHandle_t waiter = transaction.waiter;
+    transaction.result = result;
+    transaction.done = true;
+    if (waiter != nullptr) {
+        xTaskNotifyGive(waiter);
+    }
+}
+
+// === I2cDevice ===
+
+driver::I2cDevice::I2cDevice(I2cBus& bus, i2c_master_dev_handle_t handle, uint16_t address,
+                             uint32_t scl_speed_hz)
+    : bus_(bus), handle_(handle), address_(address), scl_speed_hz_(scl_speed_hz)
+{
+}
+
+driver::I2cDevice::~I2cDevice() {
+    i2c_master_bus_rm_device(handle_);
+}
+
+esp_err_t driver::I2cDevice::write(const uint8_t* data, size_t len) {
+    I2cTransaction transaction;
+    transaction.write_data = data;
+    transaction.write_len = len;
+    return transfer(transaction);
+}
+
+esp_err_t driver::I2cDevice::read(uint8_t* data, size_t len) {
+    I2cTransaction transaction;
+    transaction.read_data = data;
+    transaction.read_len = len;
+    return transfer(transaction);
+}
+
+esp_err_t driver::I2cDevice::write_read(const uint8_t* write_data, size_t write_len,
+                                        uint8_t* read_data, size_t read_len) {
+    I2cTransaction transaction;
+    transaction.write_data = write_data;
+    transaction.write_len = write_len;
+    transaction.read_data = read_data;
+    transaction.read_len = read_len;
+    return transfer(transaction);
+}
+
+esp_err_t driver::I2cDevice::probe() {
+    I2cTransaction transaction;
+    esp_err_t err = transfer(transaction);
+    return err == ESP_OK ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+esp_err_t driver::I2cDevice::submit(I2cTransaction& transaction) {
+    transaction.device = this;
+    return bus_.submit(transaction);
+}
+
+esp_err_t driver::I2cDevice::wait(I2cTransaction& transaction) {
+    // Notifications left over from earlier transactions just loop around
+    while (!transaction.done) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+    return transaction.result;
+}
+
+esp_err_t driver::I2cDevice::transfer(I2cTransaction& transaction) {
+    esp_err_t err = submit(transaction);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return wait(transaction);
+}
@@ -0,0 +1,44 @@
+#include "data_logger_app.h"
+#include "deep_sleep_logger.h"
+#include "eeprom.h"
+#include "esp_attr.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+
+// Deep sleep between samples instead of a task that waits in vTaskDelay
+static constexpr bool USE_DEEP_SLEEP = true;
+
+// Readings waiting for a full page, kept while the chip sleeps
+RTC_DATA_ATTR static app::RtcStaging rtc_staging;
+
+extern "C" void app_main() {
+    // TMP100 (0x48) and 24FC256 (0x50) share I2C0 on SDA GPIO21 / SCL GPIO22
+    driver::I2cBus bus(driver::I2cBus::Config{});
+    if (!bus.is_ready()) {
+        printf("I2C bus setup failed\n");
+        return;
+    }
+
+    driver::TemperatureSensor sensor(bus);
+    driver::Eeprom eeprom(bus);
+    driver::EepromStorage storage(eeprom);
+
+    if constexpr (USE_DEEP_SLEEP) {
+        // RTC memory is lost only with power; after a panic, watchdog or software
+        // reset the staged readings are kept if they pass their CRC
+        esp_reset_reason_t reason = esp_reset_reason();
+        bool cold_boot = reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT;
+
+        app::DeepSleepLogger logger(rtc_staging, sensor, storage, app::DeepSleepLogger::Config{});
+        app::DeepSleepLogger::WakeReport report = logger.wake(cold_boot);
+        printf("Temperature:%.2f C | %u staged | awake %.1f ms (sensor %.1f, EEPROM %.1f)\n",
+               rtc_staging.count > 0 ? rtc_staging.records[rtc_staging.count - 1].celsius : 0.0f,
+               static_cast<unsigned>(rtc_staging.count), report.awake_us / 1000.0f,
+               report.sensor_us / 1000.0f, report.commit_us / 1000.0f);
+        esp_deep_sleep(logger.sleep_us());
+    } else {
+        app::DataLoggerApp::Config config;
+        app::DataLoggerApp logger(bus, sensor, storage, config);
+        logger.run();
+    }
+}
@@ -0,0 +1,169 @@
+#include "record_codec.h"
+#include <cmath>
+#include <cstring>
+
+static constexpr float CELSIUS_PER_STEP = 0.0625f;
+static constexpr uint8_t ESCAPE = 0x80;
+
+// Zigzag maps small negative and positive numbers to small unsigned ones:
+// 0, -1, 1, -2, 2 ... -> 0, 1, 2, 3, 4 ...
+static uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+static int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+// LEB128: 7 bits per byte, low bits first, top bit set on all but the last byte
+static size_t put_varint(uint8_t* out, uint32_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = static_cast<uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = static_cast<uint8_t>(value);
+    return length;
+}
+
+// === RecordEncoder ===
+
+util::RecordEncoder::RecordEncoder(size_t capacity)
+    : capacity_(capacity < MAX_SIZE ? capacity : MAX_SIZE)
+{
+}
+
+void util::RecordEncoder::clear() {
+    size_ = 0;
+    count_ = 0;
+}
+
+bool util::RecordEncoder::append(const Record& record) {
+    int16_t steps = to_steps(record.celsius);
+    uint8_t encoded[MAX_RECORD_SIZE];
+    size_t length = 0;
+    uint32_t interval_s = 0;
+
+    if (count_ == 0) {
+        uint16_t bits = static_cast<uint16_t>(steps);
+        encoded[0] = record.timestamp_s & 0xFF;
+        encoded[1] = (record.timestamp_s >> 8) & 0xFF;
+        encoded[2] = (record.timestamp_s >> 16) & 0xFF;
+        encoded[3] = record.timestamp_s >> 24;
+        encoded[4] = bits & 0xFF;
+        encoded[5] = bits >> 8;
+        length = BASE_SIZE;
+    } else {
+        interval_s = record.timestamp_s - last_timestamp_s_;
+        int32_t jitter = static_cast<int32_t>(interval_s - last_interval_s_);
+        uint32_t change = zigzag(steps - last_steps_);
+        if (jitter == 0 && change < ESCAPE) {
+            encoded[length++] = static_cast<uint8_t>(change);
+        } else {
+            encoded[length++] = ESCAPE;
+            length += put_varint(encoded + length, zigzag(jitter));
+            length += put_varint(encoded + length, change);
+        }
+    }
+
+    if (size_ + length > capacity_) {
+        return false;
+    }
+    memcpy(data_ + size_, encoded, length);
+    size_ += length;
+    count_++;
+    last_interval_s_ = interval_s;
+    last_timestamp_s_ = record.timestamp_s;
+    last_steps_ = steps;
+    return true;
+}
+
+size_t util::RecordEncoder::max_records(size_t capacity) {
+    return capacity < BASE_SIZE ? 0 : 1 + (capacity - BASE_SIZE);
+}
+
+int16_t util::RecordEncoder::to_steps(float celsius) {
+    // The TMP100 reads -55 C to +125 C; the clamp keeps deltas within 2 varint bytes
+    float steps = std::round(celsius / CELSIUS_PER_STEP);
+    steps = std::fmax(-2048.0f, std::fmin(2047.0f, steps));
+    return static_cast<int16_t>(steps);
+}
+
+float util::RecordEncoder::to_celsius(int16_t steps) {
+    return steps * CELSIUS_PER_STEP;
+}
+
+// === RecordDecoder ===
+
+util::RecordDecoder::RecordDecoder(const uint8_t* data, size_t size)
+    : data_(data), size_(size)
+{
+}
+
+bool util::RecordDecoder::next(Record& record) {
+    if (!started_) {
+        if (size_ < RecordEncoder::BASE_SIZE) {
+            return false;
+        }
+        last_timestamp_s_ = data_[0] | (data_[1] << 8) | (data_[2] << 16) |
+                            (static_cast<uint32_t>(data_[3]) << 24);
+        last_steps_ = static_cast<int16_t>(data_[4] | (data_[5] << 8));
+        position_ = RecordEncoder::BASE_SIZE;
+        started_ = true;
+    } else {
+        if (position_ >= size_) {
+            return false;
+        }
+        uint8_t tag = data_[position_++];
+        int32_t jitter = 0;
+        uint32_t change = tag;
+        if (tag == ESCAPE) {
+            uint32_t raw_jitter = 0;
+            if (!read_varint(raw_jitter) || !read_varint(change)) {
+                return malformed();
+            }
+            jitter = unzigzag(raw_jitter);
+        } else if (tag > ESCAPE) {
+            // The encoder writes no other tags: the page is corrupt from here on
+            return malformed();
+        }
+        last_interval_s_ += jitter;
+        last_timestamp_s_ += last_interval_s_;
+        last_steps_ = static_cast<int16_t>(last_steps_ + unzigzag(change));
+    }
+
+    record.timestamp_s = last_timestamp_s_;
+    record.celsius = RecordEncoder::to_celsius(last_steps_);
+    return true;
+}
+
+bool util::RecordDecoder::skip(size_t count) {
+    Record record;
+    for (size_t i = 0; i < count; ++i) {
+        if (!next(record)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool util::RecordDecoder::malformed() {
+    // Stop for good, so later calls cannot resync on garbage
+    position_ = size_;
+    return false;
+}
+
+bool util::RecordDecoder::read_varint(uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (position_ >= size_) {
+            return false;
+        }
+        uint8_t byte = data_[position_++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
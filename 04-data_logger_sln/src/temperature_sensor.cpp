@@ -0,0 +1,127 @@
+#include "temperature_sensor.h"
+#include "freertos/task.h"
+
+// Register pointer values
+static constexpr uint8_t REG_TEMPERATURE = 0x00;
+static constexpr uint8_t REG_CONFIG = 0x01;
+
+// Configuration register bits
+static constexpr uint8_t CONFIG_SHUTDOWN = 0x01;        // SD
+static constexpr uint8_t CONFIG_ONE_SHOT = 0x80;        // OS, write-only: start a conversion in shutdown
+static constexpr uint8_t CONFIG_RESOLUTION_SHIFT = 5;   // R1:R0
+static constexpr uint8_t CONFIG_RESOLUTION_MASK = 0x3 << CONFIG_RESOLUTION_SHIFT;
+
+static constexpr float CELSIUS_PER_LSB = 0.0625f;       // 12-bit result
+// 26 ms typical; the maximum keeps the datasheet's 600/320 ratio of maximum to typical
+static constexpr uint32_t CONVERSION_12BIT_MAX_US = 48750;
+
+driver::TemperatureSensor::TemperatureSensor(I2cBus& bus, uint16_t address)
+    : device_(bus.add_device(address, SCL_SPEED_HZ)),
+      address_(address)
+{
+    // Wakes read_result() when the conversion is done instead of on a tick boundary
+    conversion_done_ = xSemaphoreCreateBinary();
+    esp_timer_create_args_t args = {};
+    args.callback = &TemperatureSensor::conversion_handler;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "tmp100_conversion";
+    if (conversion_done_ == nullptr || esp_timer_create(&args, &conversion_timer_) != ESP_OK) {
+        conversion_timer_ = nullptr;
+    }
+}
+
+driver::TemperatureSensor::~TemperatureSensor() {
+    if (conversion_timer_ != nullptr) {
+        esp_timer_stop(conversion_timer_);
+        esp_timer_delete(conversion_timer_);
+    }
+    if (conversion_done_ != nullptr) {
+        vSemaphoreDelete(conversion_done_);
+    }
+}
+
+driver::TemperatureSensor::Status driver::TemperatureSensor::read_temperature(float& celsius) {
+    if (device_ == nullptr) {
+        return Status::Error;
+    }
+
+    uint8_t pointer = REG_TEMPERATURE;
+    uint8_t raw[2] = {};
+    if (device_->write_read(&pointer, 1, raw, sizeof(raw)) != ESP_OK) {
+        return Status::BusError;
+    }
+    celsius = raw_to_celsius(raw[0], raw[1]);
+    return Status::Success;
+}
+
+driver::TemperatureSensor::Status driver::TemperatureSensor::set_resolution(Resolution resolution) {
+    if (device_ == nullptr) {
+        return Status::Error;
+    }
+
+    uint8_t config = (config_ & ~CONFIG_RESOLUTION_MASK) |
+                     (static_cast<uint8_t>(resolution) << CONFIG_RESOLUTION_SHIFT);
+    uint8_t command[2] = {REG_CONFIG, config};
+    if (device_->write(command, sizeof(command)) != ESP_OK) {
+        return Status::BusError;
+    }
+    config_ = config;
+    return Status::Success;
+}
+
+driver::TemperatureSensor::Status driver::TemperatureSensor::start_conversion() {
+    if (device_ == nullptr) {
+        return Status::Error;
+    }
+
+    uint8_t config = config_ | CONFIG_SHUTDOWN;
+    uint8_t command[2] = {REG_CONFIG, static_cast<uint8_t>(config | CONFIG_ONE_SHOT)};
+    if (device_->write(command, sizeof(command)) != ESP_OK) {
+        return Status::BusError;
+    }
+    config_ = config;
+
+    Resolution resolution = static_cast<Resolution>((config_ & CONFIG_RESOLUTION_MASK) >> CONFIG_RESOLUTION_SHIFT);
+    uint32_t conversion_us = conversion_time_us(resolution);
+    conversion_done_us_ = esp_timer_get_time() + conversion_us;
+    if (conversion_timer_ != nullptr) {
+        esp_timer_stop(conversion_timer_);
+        xSemaphoreTake(conversion_done_, 0);    // drop a wake-up from an unread conversion
+        if (esp_timer_start_once(conversion_timer_, conversion_us) != ESP_OK) {
+            return Status::Error;
+        }
+    }
+    return Status::Success;
+}
+
+driver::TemperatureSensor::Status driver::TemperatureSensor::read_result(float& celsius) {
+    // The TMP100 has no ready flag, so wait out the longest conversion time. The
+    // timer wake-up is bounded at twice the time left, so a timer that never
+    // fires costs one extra conversion time rather than a hung task.
+    int64_t remaining_us = conversion_done_us_ - esp_timer_get_time();
+    if (conversion_timer_ != nullptr && remaining_us > 0) {
+        xSemaphoreTake(conversion_done_, pdMS_TO_TICKS((2 * remaining_us + 999) / 1000) + 1);
+    }
+    while (esp_timer_get_time() < conversion_done_us_) {
+        vTaskDelay(1);
+    }
+    return read_temperature(celsius);
+}
+
+uint32_t driver::TemperatureSensor::conversion_time_us(Resolution resolution) {
+    // Halves with every bit dropped: 48.75, 24.38, 12.19, 6.09 ms (rounded up)
+    uint32_t shift = 3 - static_cast<uint32_t>(resolution);
+    return (CONVERSION_12BIT_MAX_US + (1u << shift) - 1) >> shift;
+}
+
+void driver::TemperatureSensor::conversion_handler(void* arg) {
+    auto* sensor = static_cast<TemperatureSensor*>(arg);
+    xSemaphoreGive(sensor->conversion_done_);
+}
+
+float driver::TemperatureSensor::raw_to_celsius(uint8_t msb, uint8_t lsb) {
+    // Two's complement, left-justified in 16 bits; unused low bits read as zero
+    int16_t raw = static_cast<int16_t>((msb << 8) | lsb);
+    return (raw >> 4) * CELSIUS_PER_LSB;
+}
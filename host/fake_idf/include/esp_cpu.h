@@ -0,0 +1,8 @@
+#pragma once
+#include <cstdint>
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+// On the host this counts nanoseconds of real (not virtual) time, so cycle-based
+// probes and benchmarks measure how long the host CPU actually spent
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count();
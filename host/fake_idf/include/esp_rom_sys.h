@@ -0,0 +1,8 @@
+#pragma once
+#include <cstdint>
+
+// Busy-wait: advances the virtual clock by us
+void esp_rom_delay_us(uint32_t us);
+
+// Host "cycles" are nanoseconds of real time, see esp_cpu_get_cycle_count()
+uint32_t esp_rom_get_cpu_ticks_per_us();
@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// Host stand-in for FreeRTOS as configured by ESP-IDF. Tasks are std::threads
+// scheduled against the simulator's virtual clock, see sim/kernel.h.
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define portMAX_DELAY           static_cast<TickType_t>(0xffffffffUL)
+#define configTICK_RATE_HZ      100
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       static_cast<TickType_t>((static_cast<uint64_t>(ms) * configTICK_RATE_HZ) / 1000)
+#define pdTICKS_TO_MS(ticks)    static_cast<uint32_t>((static_cast<uint64_t>(ticks) * 1000) / configTICK_RATE_HZ)
+
+#define portYIELD_FROM_ISR(...) static_cast<void>(0)
+#define tskNO_AFFINITY          0x7fffffff
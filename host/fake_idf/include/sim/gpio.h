@@ -0,0 +1,21 @@
+#pragma once
+#include "driver/gpio.h"
+#include <functional>
+
+// Virtual GPIO matrix: lets a host model play the part of the hardware wired to
+// the ESP32's pins
+namespace sim {
+
+// Drive an input pin from outside; fires the pin's ISR on a matching edge
+void drive_pin(gpio_num_t pin, int level);
+
+// Level the firmware is driving on an output pin
+int output_level(gpio_num_t pin);
+
+// Call fn(level) whenever the firmware changes an output pin
+void watch_pin(gpio_num_t pin, std::function<void(int level)> fn);
+
+// Number of times the firmware has written any output pin
+uint64_t gpio_write_count();
+
+} // namespace sim
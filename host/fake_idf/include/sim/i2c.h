@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+
+// Simulated I2C bus: device models answer the firmware's i2c_master_* transfers
+namespace sim {
+
+// One device on the bus. Callbacks run under the kernel lock. on_start() for the
+// first address byte comes when the transfer begins, so a NACK ends it early;
+// the rest come once the whole transfer has been clocked out.
+class I2cDeviceModel {
+public:
+    virtual ~I2cDeviceModel() = default;
+
+    // The device is addressed (START or repeated START). Return false to NACK,
+    // e.g. while busy with an internal write cycle.
+    virtual bool on_start(bool read) = 0;
+
+    // A byte written by the master; return false to NACK it
+    virtual bool on_write(uint8_t byte) = 0;
+
+    // The next byte the master reads
+    virtual uint8_t on_read() = 0;
+
+    // STOP condition
+    virtual void on_stop() {}
+};
+
+// Put a model at a 7-bit address on an I2C port (the model must outlive the bus)
+void attach_i2c_device(int port, uint16_t address, I2cDeviceModel* model);
+
+// Bus activity on a port
+struct I2cBusStats {
+    uint64_t transfers = 0;     // START ... STOP sequences
+    uint64_t bytes = 0;         // address and data bytes on the wire
+    uint64_t nacks = 0;         // transfers aborted by a NACK
+    int64_t busy_us = 0;        // virtual time SCL was running
+};
+I2cBusStats i2c_stats(int port);
+
+} // namespace sim
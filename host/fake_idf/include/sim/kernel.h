@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <mutex>
+
+// Discrete-event core of the host simulator.
+//
+// Virtual time only moves forward when every simulated task is blocked (it then
+// jumps to the next deadline or scheduled event), when code busy-waits with
+// esp_rom_delay_us(), or by one microsecond per esp_timer_get_time() call so that
+// polling loops make progress. Scheduled events run like interrupts: in whatever
+// thread advances the clock, with the kernel lock held.
+namespace sim {
+
+constexpr int64_t FOREVER = std::numeric_limits<int64_t>::max();
+
+using Lock = std::unique_lock<std::recursive_mutex>;
+
+// Take the kernel lock; every piece of simulated state is guarded by it
+Lock lock();
+
+// Current virtual time in microseconds
+int64_t now_us();
+
+// Move virtual time forward, running any events that fall due
+void advance_to(int64_t time_us);
+void advance_by(int64_t delta_us);
+
+// Run fn at virtual time time_us; returns an id for cancel()
+uint64_t schedule_at(int64_t time_us, std::function<void()> fn);
+uint64_t schedule_in(int64_t delay_us, std::function<void()> fn);
+void cancel(uint64_t event_id);
+
+// Block the calling thread until ready() returns true or deadline_us passes.
+// ready() runs under the kernel lock and may consume what it waits for.
+// Returns true if ready() succeeded, false on timeout.
+bool wait_until(Lock& held, int64_t deadline_us, std::function<bool()> ready);
+
+// Re-check every waiter's ready() after shared state changed
+void notify(Lock& held);
+
+// Start fn as a simulated task (a std::thread counted by the scheduler)
+void start_task(const char* name, std::function<void()> fn);
+
+// From the host's main thread: let the simulation run until virtual time
+// reaches time_us. Time then stays put until the caller blocks again.
+void run_until(int64_t time_us);
+
+} // namespace sim
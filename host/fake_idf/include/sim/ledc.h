@@ -0,0 +1,9 @@
+#pragma once
+#include "driver/ledc.h"
+
+namespace sim {
+
+// Duty the firmware last applied to an LEDC channel
+uint32_t ledc_duty(ledc_mode_t speed_mode, ledc_channel_t channel);
+
+} // namespace sim
@@ -0,0 +1,13 @@
+#pragma once
+// ESP32 GPIO register addresses used by the drivers' direct register writes.
+// On the host, REG_READ/REG_WRITE of these addresses go to the virtual GPIO matrix.
+
+#define DR_REG_GPIO_BASE        0x3ff44000
+#define GPIO_OUT_REG            (DR_REG_GPIO_BASE + 0x0004)
+#define GPIO_OUT_W1TS_REG       (DR_REG_GPIO_BASE + 0x0008)
+#define GPIO_OUT_W1TC_REG       (DR_REG_GPIO_BASE + 0x000c)
+#define GPIO_OUT1_REG           (DR_REG_GPIO_BASE + 0x0010)
+#define GPIO_OUT1_W1TS_REG      (DR_REG_GPIO_BASE + 0x0014)
+#define GPIO_OUT1_W1TC_REG      (DR_REG_GPIO_BASE + 0x0018)
+#define GPIO_IN_REG             (DR_REG_GPIO_BASE + 0x003c)
+#define GPIO_IN1_REG            (DR_REG_GPIO_BASE + 0x0040)
@@ -0,0 +1,9 @@
+#pragma once
+#include <cstdint>
+
+// Register access goes through the simulator instead of memory-mapped I/O
+uint32_t sim_reg_read(uint32_t addr);
+void sim_reg_write(uint32_t addr, uint32_t value);
+
+#define REG_READ(addr)          sim_reg_read(static_cast<uint32_t>(addr))
+#define REG_WRITE(addr, value)  sim_reg_write(static_cast<uint32_t>(addr), static_cast<uint32_t>(value))
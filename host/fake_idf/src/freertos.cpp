@@ -0,0 +1,240 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "sim/kernel.h"
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+
+static constexpr int64_t TICK_US = 1000000 / configTICK_RATE_HZ;
+
+struct sim_task {
+    std::string name;
+    uint32_t notify_value = 0;
+    bool deleted = false;
+};
+
+struct sim_semaphore {
+    UBaseType_t count;
+    UBaseType_t max_count;
+};
+
+struct sim_queue {
+    size_t length;
+    size_t item_size;
+    std::deque<std::vector<uint8_t>> items;
+};
+
+namespace {
+
+thread_local sim_task* current_task = nullptr;
+
+// Thrown by vTaskDelete(nullptr) to unwind out of the task function
+struct TaskDeleted {};
+
+int64_t deadline_after(TickType_t ticks) {
+    if (ticks == portMAX_DELAY) {
+        return sim::FOREVER;
+    }
+    return sim::now_us() + ticks * TICK_US;
+}
+
+} // namespace
+
+// ========================= TASKS =========================
+
+BaseType_t xTaskCreate(TaskFunction_t function, const char* name, uint32_t,
+                       void* arg, UBaseType_t, TaskHandle_t* created_task) {
+    auto* task = new sim_task{name ? name : ""};
+    if (created_task != nullptr) {
+        *created_task = task;
+    }
+
+    sim::start_task(task->name.c_str(), [task, function, arg]() {
+        current_task = task;
+        try {
+            function(arg);
+        } catch (const TaskDeleted&) {
+        }
+    });
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t function, const char* name, uint32_t stack_depth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* created_task,
+                                   BaseType_t) {
+    return xTaskCreate(function, name, stack_depth, arg, priority, created_task);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    if (task == nullptr || task == current_task) {
+        throw TaskDeleted{};
+    }
+    // Deleting another task is not supported by the simulator
+    task->deleted = true;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    sim::Lock held = sim::lock();
+    sim::wait_until(held, sim::now_us() + ticks * TICK_US, nullptr);
+}
+
+TickType_t xTaskGetTickCount() {
+    return static_cast<TickType_t>(sim::now_us() / TICK_US);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return current_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    sim::Lock held = sim::lock();
+    task->notify_value++;
+    sim::notify(held);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higher_priority_task_woken) {
+    xTaskNotifyGive(task);
+    if (higher_priority_task_woken != nullptr) {
+        *higher_priority_task_woken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait) {
+    sim_task* task = current_task;
+    uint32_t value = 0;
+
+    sim::Lock held = sim::lock();
+    sim::wait_until(held, deadline_after(ticks_to_wait), [&]() {
+        if (task->notify_value == 0) {
+            return false;
+        }
+        value = task->notify_value;
+        task->notify_value = clear_count_on_exit ? 0 : task->notify_value - 1;
+        return true;
+    });
+    return value;
+}
+
+// ========================= SEMAPHORES =========================
+
+SemaphoreHandle_t xSemaphoreCreateBinary() {
+    return new sim_semaphore{0, 1};
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new sim_semaphore{1, 1};
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count) {
+    return new sim_semaphore{initial_count, max_count};
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t semaphore) {
+    delete semaphore;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticks_to_wait) {
+    sim::Lock held = sim::lock();
+    int64_t deadline = ticks_to_wait == 0 ? sim::now_us() : deadline_after(ticks_to_wait);
+    bool taken = sim::wait_until(held, deadline, [semaphore]() {
+        if (semaphore->count == 0) {
+            return false;
+        }
+        semaphore->count--;
+        return true;
+    });
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+    sim::Lock held = sim::lock();
+    if (semaphore->count >= semaphore->max_count) {
+        return pdFALSE;
+    }
+    semaphore->count++;
+    sim::notify(held);
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t semaphore, BaseType_t* higher_priority_task_woken) {
+    BaseType_t given = xSemaphoreGive(semaphore);
+    if (higher_priority_task_woken != nullptr && given == pdTRUE) {
+        *higher_priority_task_woken = pdTRUE;
+    }
+    return given;
+}
+
+// ========================= QUEUES =========================
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    return new sim_queue{length, item_size, {}};
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    delete queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    sim::Lock held = sim::lock();
+    int64_t deadline = ticks_to_wait == 0 ? sim::now_us() : deadline_after(ticks_to_wait);
+    bool sent = sim::wait_until(held, deadline, [queue, item]() {
+        if (queue->items.size() >= queue->length) {
+            return false;
+        }
+        const auto* bytes = static_cast<const uint8_t*>(item);
+        queue->items.emplace_back(bytes, bytes + queue->item_size);
+        return true;
+    });
+    if (sent) {
+        sim::notify(held);
+    }
+    return sent ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait) {
+    return xQueueSend(queue, item, ticks_to_wait);
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void* item, BaseType_t* higher_priority_task_woken) {
+    BaseType_t sent = xQueueSend(queue, item, 0);
+    if (higher_priority_task_woken != nullptr && sent == pdTRUE) {
+        *higher_priority_task_woken = pdTRUE;
+    }
+    return sent;
+}
+
+static BaseType_t queue_read(QueueHandle_t queue, void* buffer, TickType_t ticks_to_wait, bool remove) {
+    sim::Lock held = sim::lock();
+    int64_t deadline = ticks_to_wait == 0 ? sim::now_us() : deadline_after(ticks_to_wait);
+    bool received = sim::wait_until(held, deadline, [queue, buffer, remove]() {
+        if (queue->items.empty()) {
+            return false;
+        }
+        std::memcpy(buffer, queue->items.front().data(), queue->item_size);
+        if (remove) {
+            queue->items.pop_front();
+        }
+        return true;
+    });
+    if (received && remove) {
+        sim::notify(held);
+    }
+    return received ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* buffer, TickType_t ticks_to_wait) {
+    return queue_read(queue, buffer, ticks_to_wait, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* buffer, TickType_t ticks_to_wait) {
+    return queue_read(queue, buffer, ticks_to_wait, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    sim::Lock held = sim::lock();
+    return static_cast<UBaseType_t>(queue->items.size());
+}
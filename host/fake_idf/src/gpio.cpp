@@ -0,0 +1,221 @@
+#include "driver/gpio.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "sim/gpio.h"
+#include "sim/kernel.h"
+#include <vector>
+
+namespace {
+
+struct Pin {
+    gpio_mode_t mode = GPIO_MODE_DISABLE;
+    gpio_int_type_t intr_type = GPIO_INTR_DISABLE;
+    int input_level = 0;
+    int output_level = 0;
+    gpio_isr_t isr = nullptr;
+    void* isr_arg = nullptr;
+    std::vector<std::function<void(int)>> watchers;
+};
+
+Pin pins[GPIO_NUM_MAX];
+bool isr_service_installed = false;
+uint64_t write_count = 0;
+
+bool valid(gpio_num_t gpio_num) {
+    return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX;
+}
+
+bool is_input_only(const Pin& pin) {
+    return pin.mode == GPIO_MODE_INPUT || pin.mode == GPIO_MODE_DISABLE;
+}
+
+// Requires the kernel lock. Watchers see a write only after every pin it
+// touches has changed, like a single register write on the chip.
+void write_bank(int first_pin, uint32_t set_mask, uint32_t clear_mask) {
+    ++write_count;
+
+    uint32_t changed = 0;
+    for (int bit = 0; bit < 32 && first_pin + bit < GPIO_NUM_MAX; ++bit) {
+        int level;
+        if (set_mask & (1u << bit)) {
+            level = 1;
+        } else if (clear_mask & (1u << bit)) {
+            level = 0;
+        } else {
+            continue;
+        }
+        Pin& pin = pins[first_pin + bit];
+        if (pin.output_level != level) {
+            pin.output_level = level;
+            changed |= 1u << bit;
+        }
+    }
+
+    for (int bit = 0; bit < 32 && changed != 0; ++bit) {
+        if (changed & (1u << bit)) {
+            const Pin& pin = pins[first_pin + bit];
+            for (auto& watcher : pin.watchers) {
+                watcher(pin.output_level);
+            }
+        }
+    }
+}
+
+void write_output(int gpio_num, int level) {
+    int first_pin = gpio_num < 32 ? 0 : 32;
+    uint32_t bit = 1u << (gpio_num - first_pin);
+    write_bank(first_pin, level ? bit : 0, level ? 0 : bit);
+}
+
+uint32_t read_bank(int first_pin, bool outputs) {
+    uint32_t value = 0;
+    for (int bit = 0; bit < 32 && first_pin + bit < GPIO_NUM_MAX; ++bit) {
+        const Pin& pin = pins[first_pin + bit];
+        int level = (outputs || !is_input_only(pin)) ? pin.output_level : pin.input_level;
+        value |= static_cast<uint32_t>(level) << bit;
+    }
+    return value;
+}
+
+} // namespace
+
+// ========================= ESP-IDF API =========================
+
+esp_err_t gpio_config(const gpio_config_t* cfg) {
+    sim::Lock held = sim::lock();
+    for (int i = 0; i < GPIO_NUM_MAX; ++i) {
+        if (cfg->pin_bit_mask & (1ULL << i)) {
+            pins[i].mode = cfg->mode;
+            pins[i].intr_type = cfg->intr_type;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (!valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    write_output(gpio_num, level ? 1 : 0);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (!valid(gpio_num)) {
+        return 0;
+    }
+    sim::Lock held = sim::lock();
+    const Pin& pin = pins[gpio_num];
+    return is_input_only(pin) ? pin.input_level : pin.output_level;
+}
+
+esp_err_t gpio_set_intr_type(gpio_num_t gpio_num, gpio_int_type_t intr_type) {
+    if (!valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    pins[gpio_num].intr_type = intr_type;
+    return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service(int) {
+    sim::Lock held = sim::lock();
+    if (isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    isr_service_installed = true;
+    return ESP_OK;
+}
+
+void gpio_uninstall_isr_service() {
+    sim::Lock held = sim::lock();
+    isr_service_installed = false;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void* args) {
+    if (!valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    if (!isr_service_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pins[gpio_num].isr = isr_handler;
+    pins[gpio_num].isr_arg = args;
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) {
+    if (!valid(gpio_num)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    pins[gpio_num].isr = nullptr;
+    pins[gpio_num].isr_arg = nullptr;
+    return ESP_OK;
+}
+
+// ========================= REGISTERS =========================
+
+uint32_t sim_reg_read(uint32_t addr) {
+    sim::Lock held = sim::lock();
+    switch (addr) {
+        case GPIO_OUT_REG:  return read_bank(0, true);
+        case GPIO_OUT1_REG: return read_bank(32, true);
+        case GPIO_IN_REG:   return read_bank(0, false);
+        case GPIO_IN1_REG:  return read_bank(32, false);
+        default:            return 0;
+    }
+}
+
+void sim_reg_write(uint32_t addr, uint32_t value) {
+    sim::Lock held = sim::lock();
+    switch (addr) {
+        case GPIO_OUT_W1TS_REG:  write_bank(0, value, 0); break;
+        case GPIO_OUT_W1TC_REG:  write_bank(0, 0, value); break;
+        case GPIO_OUT1_W1TS_REG: write_bank(32, value, 0); break;
+        case GPIO_OUT1_W1TC_REG: write_bank(32, 0, value); break;
+        case GPIO_OUT_REG:       write_bank(0, value, ~value); break;
+        case GPIO_OUT1_REG:      write_bank(32, value, ~value); break;
+        default: break;
+    }
+}
+
+// ========================= SIMULATOR HOOKS =========================
+
+void sim::drive_pin(gpio_num_t gpio_num, int level) {
+    Lock held = lock();
+    Pin& pin = pins[gpio_num];
+    level = level ? 1 : 0;
+    if (pin.input_level == level) {
+        return;
+    }
+    pin.input_level = level;
+
+    bool rising = level == 1;
+    bool fire = (pin.intr_type == GPIO_INTR_ANYEDGE) ||
+                (pin.intr_type == GPIO_INTR_POSEDGE && rising) ||
+                (pin.intr_type == GPIO_INTR_NEGEDGE && !rising) ||
+                (pin.intr_type == GPIO_INTR_HIGH_LEVEL && rising) ||
+                (pin.intr_type == GPIO_INTR_LOW_LEVEL && !rising);
+    if (fire && isr_service_installed && pin.isr != nullptr) {
+        pin.isr(pin.isr_arg);
+    }
+    notify(held);
+}
+
+int sim::output_level(gpio_num_t gpio_num) {
+    Lock held = lock();
+    return pins[gpio_num].output_level;
+}
+
+void sim::watch_pin(gpio_num_t gpio_num, std::function<void(int level)> fn) {
+    Lock held = lock();
+    pins[gpio_num].watchers.push_back(std::move(fn));
+}
+
+uint64_t sim::gpio_write_count() {
+    Lock held = lock();
+    return write_count;
+}
@@ -0,0 +1,167 @@
+#include "driver/i2c_master.h"
+#include "sim/i2c.h"
+#include "sim/kernel.h"
+#include <map>
+
+struct i2c_master_bus_t {
+    i2c_port_num_t port;
+    bool busy = false;          // a transfer is on the wire
+};
+
+struct i2c_master_dev_t {
+    i2c_master_bus_t* bus;
+    uint16_t address;
+    uint32_t scl_speed_hz;
+};
+
+namespace {
+
+std::map<uint16_t, sim::I2cDeviceModel*> devices[I2C_NUM_MAX];
+sim::I2cBusStats stats[I2C_NUM_MAX];
+
+constexpr uint32_t BITS_PER_BYTE = 9;   // 8 data bits + ACK
+
+int64_t wire_time_us(uint32_t bits, uint32_t scl_speed_hz) {
+    return (static_cast<int64_t>(bits) * 1000000 + scl_speed_hz - 1) / scl_speed_hz;
+}
+
+// One START/repeated START segment of a transfer
+struct Segment {
+    bool read;
+    const uint8_t* write_data;
+    uint8_t* read_data;
+    size_t length;
+};
+
+// Run a complete START ... STOP transfer against the model at the device's address
+esp_err_t transfer(i2c_port_num_t port, uint16_t address, uint32_t scl_speed_hz,
+                   const Segment* segments, size_t segment_count, i2c_master_bus_t* bus) {
+    sim::Lock held = sim::lock();
+
+    // One transfer at a time per bus, like the driver's bus lock
+    sim::wait_until(held, sim::FOREVER, [bus]() {
+        if (bus->busy) {
+            return false;
+        }
+        bus->busy = true;
+        return true;
+    });
+
+    auto it = devices[port].find(address);
+    sim::I2cDeviceModel* model = it != devices[port].end() ? it->second : nullptr;
+    sim::I2cBusStats& bus_stats = stats[port];
+    bus_stats.transfers++;
+
+    auto finish = [&](uint32_t bits, size_t bytes, esp_err_t result) {
+        int64_t duration_us = wire_time_us(bits + 1, scl_speed_hz);     // + STOP
+        sim::wait_until(held, sim::now_us() + duration_us, nullptr);
+        bus_stats.bytes += bytes;
+        bus_stats.busy_us += duration_us;
+        if (result != ESP_OK) {
+            bus_stats.nacks++;
+        }
+        if (model != nullptr) {
+            model->on_stop();
+        }
+        bus->busy = false;
+        sim::notify(held);
+        return result;
+    };
+
+    // The address byte of the first segment decides whether anyone answers
+    if (model == nullptr || !model->on_start(segments[0].read)) {
+        return finish(1 + BITS_PER_BYTE, 1, ESP_ERR_INVALID_RESPONSE);
+    }
+
+    // Everything else is on the wire before the model sees the data
+    uint32_t bits = 0;
+    size_t bytes = 0;
+    for (size_t i = 0; i < segment_count; ++i) {
+        bits += 1 + BITS_PER_BYTE * (1 + segments[i].length);
+        bytes += 1 + segments[i].length;
+    }
+    sim::wait_until(held, sim::now_us() + wire_time_us(bits, scl_speed_hz), nullptr);
+
+    for (size_t i = 0; i < segment_count; ++i) {
+        const Segment& segment = segments[i];
+        if (i > 0 && !model->on_start(segment.read)) {
+            return finish(0, bytes, ESP_ERR_INVALID_RESPONSE);
+        }
+        for (size_t b = 0; b < segment.length; ++b) {
+            if (segment.read) {
+                segment.read_data[b] = model->on_read();
+            } else if (!model->on_write(segment.write_data[b])) {
+                return finish(0, bytes, ESP_ERR_INVALID_RESPONSE);
+            }
+        }
+    }
+    return finish(0, bytes, ESP_OK);
+}
+
+} // namespace
+
+esp_err_t i2c_new_master_bus(const i2c_master_bus_config_t* bus_config, i2c_master_bus_handle_t* ret_bus_handle) {
+    if (bus_config == nullptr || ret_bus_handle == nullptr ||
+        bus_config->i2c_port < 0 || bus_config->i2c_port >= I2C_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ret_bus_handle = new i2c_master_bus_t{bus_config->i2c_port};
+    return ESP_OK;
+}
+
+esp_err_t i2c_del_master_bus(i2c_master_bus_handle_t bus_handle) {
+    delete bus_handle;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_add_device(i2c_master_bus_handle_t bus_handle, const i2c_device_config_t* dev_config,
+                                    i2c_master_dev_handle_t* ret_handle) {
+    if (bus_handle == nullptr || dev_config == nullptr || ret_handle == nullptr ||
+        dev_config->scl_speed_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ret_handle = new i2c_master_dev_t{bus_handle, dev_config->device_address, dev_config->scl_speed_hz};
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_bus_rm_device(i2c_master_dev_handle_t handle) {
+    delete handle;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_transmit(i2c_master_dev_handle_t i2c_dev, const uint8_t* write_buffer, size_t write_size,
+                              int) {
+    Segment segment{false, write_buffer, nullptr, write_size};
+    return transfer(i2c_dev->bus->port, i2c_dev->address, i2c_dev->scl_speed_hz, &segment, 1, i2c_dev->bus);
+}
+
+esp_err_t i2c_master_receive(i2c_master_dev_handle_t i2c_dev, uint8_t* read_buffer, size_t read_size, int) {
+    Segment segment{true, nullptr, read_buffer, read_size};
+    return transfer(i2c_dev->bus->port, i2c_dev->address, i2c_dev->scl_speed_hz, &segment, 1, i2c_dev->bus);
+}
+
+esp_err_t i2c_master_transmit_receive(i2c_master_dev_handle_t i2c_dev, const uint8_t* write_buffer,
+                                      size_t write_size, uint8_t* read_buffer, size_t read_size, int) {
+    Segment segments[2] = {
+        {false, write_buffer, nullptr, write_size},
+        {true, nullptr, read_buffer, read_size},
+    };
+    return transfer(i2c_dev->bus->port, i2c_dev->address, i2c_dev->scl_speed_hz, segments, 2, i2c_dev->bus);
+}
+
+esp_err_t i2c_master_probe(i2c_master_bus_handle_t bus_handle, uint16_t address, int) {
+    // The driver probes at 100 kHz
+    Segment segment{false, nullptr, nullptr, 0};
+    esp_err_t err = transfer(bus_handle->port, address, 100000, &segment, 1, bus_handle);
+    return err == ESP_OK ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void sim::attach_i2c_device(int port, uint16_t address, I2cDeviceModel* model) {
+    Lock held = lock();
+    devices[port][address] = model;
+}
+
+sim::I2cBusStats sim::i2c_stats(int port) {
+    Lock held = lock();
+    return stats[port];
+}
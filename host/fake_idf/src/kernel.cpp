@@ -0,0 +1,207 @@
+#include "sim/kernel.h"
+#include <algorithm>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <thread>
+
+namespace {
+
+struct Waiter {
+    int64_t deadline_us;
+    std::function<bool()> ready;
+    bool is_task;           // host threads waiting in run_until() are not tasks
+    bool woken = false;
+    bool satisfied = false;
+};
+
+struct Event {
+    uint64_t id;
+    std::function<void()> fn;
+};
+
+struct Kernel {
+    std::recursive_mutex mutex;
+    std::condition_variable_any wakeup;
+    int64_t now_us = 0;
+    int running_tasks = 0;          // tasks that are not blocked
+    std::list<Waiter*> waiters;
+    std::multimap<int64_t, Event> events;
+    uint64_t next_event_id = 1;
+    bool in_event = false;          // an event handler is running
+};
+
+Kernel& kernel() {
+    static Kernel k;
+    return k;
+}
+
+thread_local bool is_task_thread = false;
+
+void wake(Kernel& k, Waiter& w, bool satisfied) {
+    w.woken = true;
+    w.satisfied = satisfied;
+    if (w.is_task) {
+        ++k.running_tasks;
+    }
+}
+
+// Requires the lock. Wake waiters whose condition now holds or whose time is up.
+void check_waiters(Kernel& k) {
+    for (Waiter* w : k.waiters) {
+        if (w->woken) {
+            continue;
+        }
+        if (w->ready && w->ready()) {
+            wake(k, *w, true);
+        } else if (w->deadline_us <= k.now_us) {
+            wake(k, *w, false);
+        }
+    }
+    k.wakeup.notify_all();
+}
+
+// Requires the lock. Everything is blocked: jump to the next thing that can happen.
+bool advance_to_next(Kernel& k) {
+    int64_t next = k.events.empty() ? sim::FOREVER : k.events.begin()->first;
+    for (const Waiter* w : k.waiters) {
+        if (!w->woken) {
+            next = std::min(next, w->deadline_us);
+        }
+    }
+    if (next == sim::FOREVER) {
+        return false;
+    }
+    sim::advance_to(std::max(next, k.now_us));
+    return true;
+}
+
+} // namespace
+
+sim::Lock sim::lock() {
+    return Lock(kernel().mutex);
+}
+
+int64_t sim::now_us() {
+    Lock held = lock();
+    return kernel().now_us;
+}
+
+void sim::advance_to(int64_t time_us) {
+    Kernel& k = kernel();
+    Lock held = lock();
+
+    // Events run one at a time; an event that reads the clock must not recurse
+    if (k.in_event) {
+        return;
+    }
+
+    while (!k.events.empty() && k.events.begin()->first <= time_us) {
+        auto it = k.events.begin();
+        k.now_us = std::max(k.now_us, it->first);
+        std::function<void()> fn = std::move(it->second.fn);
+        k.events.erase(it);
+
+        k.in_event = true;
+        fn();
+        k.in_event = false;
+    }
+
+    k.now_us = std::max(k.now_us, time_us);
+    check_waiters(k);
+}
+
+void sim::advance_by(int64_t delta_us) {
+    Lock held = lock();
+    advance_to(kernel().now_us + delta_us);
+}
+
+uint64_t sim::schedule_at(int64_t time_us, std::function<void()> fn) {
+    Kernel& k = kernel();
+    Lock held = lock();
+    uint64_t id = k.next_event_id++;
+    k.events.emplace(std::max(time_us, k.now_us), Event{id, std::move(fn)});
+    k.wakeup.notify_all();
+    return id;
+}
+
+uint64_t sim::schedule_in(int64_t delay_us, std::function<void()> fn) {
+    Lock held = lock();
+    return schedule_at(kernel().now_us + delay_us, std::move(fn));
+}
+
+void sim::cancel(uint64_t event_id) {
+    Kernel& k = kernel();
+    Lock held = lock();
+    for (auto it = k.events.begin(); it != k.events.end(); ++it) {
+        if (it->second.id == event_id) {
+            k.events.erase(it);
+            return;
+        }
+    }
+}
+
+void sim::notify(Lock&) {
+    check_waiters(kernel());
+}
+
+bool sim::wait_until(Lock& held, int64_t deadline_us, std::function<bool()> ready) {
+    Kernel& k = kernel();
+
+    if (ready && ready()) {
+        return true;
+    }
+    if (deadline_us <= k.now_us) {
+        return false;
+    }
+
+    Waiter w{deadline_us, std::move(ready), is_task_thread};
+    k.waiters.push_back(&w);
+    if (w.is_task) {
+        --k.running_tasks;
+    }
+
+    while (!w.woken) {
+        // The last runnable task to block moves time forward for everyone
+        if (k.running_tasks == 0 && advance_to_next(k)) {
+            continue;
+        }
+        k.wakeup.wait(held);
+    }
+
+    k.waiters.remove(&w);
+    return w.satisfied;
+}
+
+void sim::start_task(const char* name, std::function<void()> fn) {
+    Kernel& k = kernel();
+    {
+        Lock held = lock();
+        ++k.running_tasks;
+    }
+
+    std::thread([fn = std::move(fn), name]() {
+        static_cast<void>(name);
+        is_task_thread = true;
+        fn();
+
+        // The task ended: it no longer holds time back
+        Kernel& k = kernel();
+        Lock held = lock();
+        --k.running_tasks;
+        k.wakeup.notify_all();
+    }).detach();
+}
+
+void sim::run_until(int64_t time_us) {
+    Kernel& k = kernel();
+    Lock held = lock();
+
+    // The host thread joins the scheduler as a task, so once it wakes up time
+    // stands still until it waits again
+    if (!is_task_thread) {
+        is_task_thread = true;
+        ++k.running_tasks;
+    }
+    wait_until(held, time_us, nullptr);
+}
@@ -0,0 +1,128 @@
+#include "driver/ledc.h"
+#include "sim/ledc.h"
+#include "sim/kernel.h"
+
+namespace {
+
+struct Channel {
+    uint32_t pending_duty = 0;      // set by ledc_set_duty, applied by ledc_update_duty
+    uint32_t duty = 0;
+    uint32_t fade_target = 0;
+    int fade_time_ms = 0;
+    uint64_t fade_event = 0;        // 0 when no fade is running
+};
+
+Channel channels[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX];
+bool fade_installed = false;
+
+bool valid(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    return speed_mode >= 0 && speed_mode < LEDC_SPEED_MODE_MAX &&
+           channel >= 0 && channel < LEDC_CHANNEL_MAX;
+}
+
+} // namespace
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* timer_conf) {
+    return timer_conf != nullptr ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* ledc_conf) {
+    if (ledc_conf == nullptr || !valid(ledc_conf->speed_mode, ledc_conf->channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    Channel& ch = channels[ledc_conf->speed_mode][ledc_conf->channel];
+    ch.pending_duty = ch.duty = ledc_conf->duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty) {
+    if (!valid(speed_mode, channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    channels[speed_mode][channel].pending_duty = duty;
+    return ESP_OK;
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    if (!valid(speed_mode, channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    Channel& ch = channels[speed_mode][channel];
+    ch.duty = ch.pending_duty;
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    return sim::ledc_duty(speed_mode, channel);
+}
+
+esp_err_t ledc_fade_func_install(int) {
+    sim::Lock held = sim::lock();
+    if (fade_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    fade_installed = true;
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t speed_mode, ledc_channel_t channel,
+                                  uint32_t target_duty, int max_fade_time_ms) {
+    if (!valid(speed_mode, channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    if (!fade_installed) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    Channel& ch = channels[speed_mode][channel];
+    ch.fade_target = target_duty;
+    ch.fade_time_ms = max_fade_time_ms;
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t speed_mode, ledc_channel_t channel, ledc_fade_mode_t fade_mode) {
+    if (!valid(speed_mode, channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    Channel& ch = channels[speed_mode][channel];
+    if (ch.fade_event != 0) {
+        sim::cancel(ch.fade_event);
+    }
+
+    // The duty jumps to its target when the fade would have finished
+    int64_t done_us = sim::now_us() + static_cast<int64_t>(ch.fade_time_ms) * 1000;
+    ch.fade_event = sim::schedule_at(done_us, [&ch]() {
+        ch.duty = ch.pending_duty = ch.fade_target;
+        ch.fade_event = 0;
+    });
+
+    if (fade_mode == LEDC_FADE_WAIT_DONE) {
+        sim::wait_until(held, sim::FOREVER, [&ch]() { return ch.fade_event == 0; });
+    }
+    return ESP_OK;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    if (!valid(speed_mode, channel)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    sim::Lock held = sim::lock();
+    Channel& ch = channels[speed_mode][channel];
+    if (ch.fade_event != 0) {
+        sim::cancel(ch.fade_event);
+        ch.fade_event = 0;
+    }
+    return ESP_OK;
+}
+
+uint32_t sim::ledc_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    if (!valid(speed_mode, channel)) {
+        return 0;
+    }
+    Lock held = lock();
+    return channels[speed_mode][channel].duty;
+}
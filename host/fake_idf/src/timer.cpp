@@ -0,0 +1,134 @@
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "esp_cpu.h"
+#include "sim/kernel.h"
+#include <chrono>
+#include <deque>
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    uint64_t period_us;     // 0 for one-shot
+    uint64_t event_id;
+    bool active;
+};
+
+namespace {
+
+// Callbacks run in a dedicated simulated task, like ESP_TIMER_TASK dispatch
+std::deque<esp_timer*> expired;
+bool timer_task_started = false;
+
+void timer_task() {
+    while (true) {
+        esp_timer* timer = nullptr;
+        {
+            sim::Lock held = sim::lock();
+            sim::wait_until(held, sim::FOREVER, [&timer]() {
+                if (expired.empty()) {
+                    return false;
+                }
+                timer = expired.front();
+                expired.pop_front();
+                return true;
+            });
+        }
+        timer->callback(timer->arg);
+    }
+}
+
+// Requires the kernel lock
+void arm(esp_timer* timer, int64_t fire_at_us) {
+    timer->active = true;
+    timer->event_id = sim::schedule_at(fire_at_us, [timer, fire_at_us]() {
+        if (timer->period_us > 0) {
+            arm(timer, fire_at_us + static_cast<int64_t>(timer->period_us));
+        } else {
+            timer->active = false;
+        }
+        expired.push_back(timer);
+    });
+}
+
+} // namespace
+
+int64_t esp_timer_get_time() {
+    // Reading the clock costs a microsecond, so polling loops move time forward
+    sim::Lock held = sim::lock();
+    sim::advance_by(1);
+    return sim::now_us();
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* out_handle) {
+    if (args == nullptr || args->callback == nullptr || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    sim::Lock held = sim::lock();
+    if (!timer_task_started) {
+        timer_task_started = true;
+        sim::start_task("esp_timer", timer_task);
+    }
+    *out_handle = new esp_timer{args->callback, args->arg, 0, 0, false};
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    sim::Lock held = sim::lock();
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->period_us = 0;
+    arm(timer, sim::now_us() + static_cast<int64_t>(timeout_us));
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    sim::Lock held = sim::lock();
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->period_us = period_us;
+    arm(timer, sim::now_us() + static_cast<int64_t>(period_us));
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    sim::Lock held = sim::lock();
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    sim::cancel(timer->event_id);
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    sim::Lock held = sim::lock();
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (auto it = expired.begin(); it != expired.end();) {
+        it = (*it == timer) ? expired.erase(it) : it + 1;
+    }
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    sim::Lock held = sim::lock();
+    return timer->active;
+}
+
+void esp_rom_delay_us(uint32_t us) {
+    sim::advance_by(us);
+}
+
+uint32_t esp_rom_get_cpu_ticks_per_us() {
+    return 1000;
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<esp_cpu_cycle_count_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}